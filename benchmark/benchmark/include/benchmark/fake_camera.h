@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmark
+{
+	struct fake_camera_config
+	{
+		std::string ip = "127.0.0.1";
+		uint16_t data_port = 2114;
+		int width = 512;
+		int height = 424;
+		// 0 sends frames as fast as the socket accepts them
+		double fps = 30.0;
+	};
+
+	/**
+	 * @brief Localhost stand-in for a Visionary-T Mini.
+	 *
+	 * Serves pre-encoded blobs on the data port and answers every CoLa-2 request on the control port
+	 * (2122) with a success response, which is enough for camera::camera_handler::open to succeed.
+	 */
+	class fake_camera
+	{
+	public:
+		fake_camera(const fake_camera_config& config);
+		~fake_camera();
+
+		const bool start();
+		void stop();
+
+		const bool sent_time(const uint32_t frame_number, std::chrono::steady_clock::time_point& time) const;
+		const uint64_t frames_sent() const;
+
+	private:
+		struct sent_frame
+		{
+			uint32_t number;
+			std::chrono::steady_clock::time_point time;
+		};
+
+		static constexpr size_t num_blobs = 64;
+		static constexpr size_t sent_history = 4096;
+
+		const fake_camera_config _config;
+
+		std::atomic_bool _stop;
+		std::atomic<uint64_t> _frames_sent;
+
+		std::vector<std::vector<uint8_t>> _blobs;
+		size_t _frame_number_offset;
+
+		mutable std::mutex _sent_mutex;
+		std::vector<sent_frame> _sent;
+
+		intptr_t _control_listener;
+		intptr_t _data_listener;
+		std::thread _control_thread;
+		std::thread _data_thread;
+
+		void encode_blobs();
+		void run_control();
+		void run_data();
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "3pp/snap7/snap7.h"
+
+namespace benchmark
+{
+	/**
+	 * @brief Localhost snap7 server exposing a single data block, used in place of a real PLC.
+	 */
+	class fake_plc
+	{
+	public:
+		fake_plc(const int db_number, const int db_size_bytes);
+		~fake_plc();
+
+		const bool start(const std::string& ip);
+		void stop();
+
+		const uint64_t writes() const;
+
+	private:
+		TS7Server server;
+		const int db_number;
+		std::vector<uint8_t> db;
+		std::atomic<uint64_t> write_count;
+		bool started;
+
+		static void S7API on_event(void* usr, PSrvEvent event, int size);
+	};
+}
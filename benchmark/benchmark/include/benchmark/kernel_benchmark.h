@@ -0,0 +1,18 @@
+#pragma once
+
+#define JSON_USE_IMPLICIT_CONVERSIONS 0
+#include "json.hpp"
+
+namespace benchmark
+{
+	/**
+	 * @brief Times the fixed point blur kernels against the OpenCV functions they replace on a synthetic
+	 * uint16 depth image.
+	 *
+	 * @param width Image width
+	 * @param height Image height
+	 * @param iterations Calls timed per kernel and implementation
+	 * @return One entry per kernel with mean time per call of both implementations and their largest difference
+	 */
+	const nlohmann::json run_kernel_benchmark(const int width, const int height, const int iterations);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#define JSON_USE_IMPLICIT_CONVERSIONS 0
+#include "json.hpp"
+
+namespace benchmark
+{
+	/**
+	 * @brief Times 'VisionaryData::generatePointCloud' against the per pixel scalar conversion it replaced, and
+	 * 'generateWorldPointCloud' against 'generatePointCloud' followed by 'transformPointCloud', on a synthetic
+	 * distance image.
+	 *
+	 * @param width Image width
+	 * @param height Image height
+	 * @param iterations Calls timed per implementation
+	 * @return Mean time per call of every variant and the largest coordinate differences between the results
+	 */
+	const nlohmann::json run_point_cloud_benchmark(const int width, const int height, const int iterations);
+}
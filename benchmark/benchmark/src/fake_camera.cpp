@@ -0,0 +1,390 @@
+#include "benchmark/fake_camera.h"
+
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib,"ws2_32.lib")
+#endif
+typedef SOCKET socket_t;
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (socket_t(~0))
+#define closesocket close
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	// CoLa-2 control port used by visionary::VisionaryControl
+	constexpr uint16_t control_port = 2122;
+	constexpr int accept_timeout_ms = 100;
+
+	socket_t open_listener(const std::string& ip, const uint16_t port)
+	{
+		socket_t listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (listener == INVALID_SOCKET)
+			return INVALID_SOCKET;
+
+		const int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr.s_addr) != 1
+			|| ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+			|| ::listen(listener, 1) != 0)
+		{
+			closesocket(listener);
+			return INVALID_SOCKET;
+		}
+
+		return listener;
+	}
+
+	// waits up to 'timeout_ms' for the socket to become readable so the server threads can observe stop requests
+	const bool wait_readable(const socket_t socket, const int timeout_ms)
+	{
+		fd_set set;
+		FD_ZERO(&set);
+		FD_SET(socket, &set);
+		timeval tv{};
+		tv.tv_sec = timeout_ms / 1000;
+		tv.tv_usec = (timeout_ms % 1000) * 1000;
+		return select(static_cast<int>(socket + 1), &set, nullptr, nullptr, &tv) > 0;
+	}
+
+	const bool send_all(const socket_t socket, const uint8_t* data, size_t size)
+	{
+		while (size > 0)
+		{
+			const int sent = ::send(socket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0);
+			if (sent <= 0)
+				return false;
+			data += sent;
+			size -= static_cast<size_t>(sent);
+		}
+		return true;
+	}
+
+	const bool recv_all(const socket_t socket, uint8_t* data, size_t size, const std::atomic_bool& stop)
+	{
+		while (size > 0)
+		{
+			if (stop)
+				return false;
+			if (!wait_readable(socket, accept_timeout_ms))
+				continue;
+
+			const int received = ::recv(socket, reinterpret_cast<char*>(data), static_cast<int>(size), 0);
+			if (received <= 0)
+				return false;
+			data += received;
+			size -= static_cast<size_t>(received);
+		}
+		return true;
+	}
+
+	void put_be32(uint8_t* p, const uint32_t value)
+	{
+		p[0] = static_cast<uint8_t>(value >> 24);
+		p[1] = static_cast<uint8_t>(value >> 16);
+		p[2] = static_cast<uint8_t>(value >> 8);
+		p[3] = static_cast<uint8_t>(value);
+	}
+
+	template<typename T>
+	void append_le(std::vector<uint8_t>& buffer, const T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+			buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+	}
+
+	const std::string camera_xml(const int width, const int height)
+	{
+		std::stringstream xml;
+		xml << "<SickRecord><DataSets><DataSetDepthMap><FormatDescriptionDepthMap><DataStream>"
+			<< "<Width>" << width << "</Width><Height>" << height << "</Height>"
+			<< "<CameraToWorldTransform>";
+		for (int i = 0; i < 16; ++i)
+			xml << "<value>" << (i % 5 == 0 ? 1.0 : 0.0) << "</value>";
+		xml << "</CameraToWorldTransform>"
+			<< "<CameraMatrix><FX>" << width * 0.715 << "</FX><FY>" << width * 0.715 << "</FY>"
+			<< "<CX>" << width / 2.0 << "</CX><CY>" << height / 2.0 << "</CY></CameraMatrix>"
+			<< "<CameraDistortionParams><K1>0</K1><K2>0</K2><P1>0</P1><P2>0</P2><K3>0</K3></CameraDistortionParams>"
+			<< "<FocalToRayCross>0</FocalToRayCross>"
+			<< "<Distance>uint16</Distance><Intensity>uint16</Intensity><Confidence>uint16</Confidence>"
+			<< "</DataStream></FormatDescriptionDepthMap></DataSetDepthMap></DataSets></SickRecord>";
+		return xml.str();
+	}
+}
+
+benchmark::fake_camera::fake_camera(const fake_camera_config& config)
+	: _config(config), _stop(false), _frames_sent(0), _frame_number_offset(0), _sent(sent_history),
+	_control_listener(static_cast<intptr_t>(INVALID_SOCKET)), _data_listener(static_cast<intptr_t>(INVALID_SOCKET))
+{
+	encode_blobs();
+}
+
+benchmark::fake_camera::~fake_camera()
+{
+	stop();
+}
+
+const bool benchmark::fake_camera::start()
+{
+#ifdef _WIN32
+	WSADATA wsa_data;
+	if (::WSAStartup(MAKEWORD(2, 2), &wsa_data) != NO_ERROR)
+		return false;
+#endif
+
+	const socket_t control_listener = open_listener(_config.ip, control_port);
+	const socket_t data_listener = open_listener(_config.ip, _config.data_port);
+	if (control_listener == INVALID_SOCKET || data_listener == INVALID_SOCKET)
+	{
+		spdlog::get("benchmark")->error("Fake camera failed to listen on {} ports {} and {}", _config.ip, control_port, _config.data_port);
+		if (control_listener != INVALID_SOCKET)
+			closesocket(control_listener);
+		if (data_listener != INVALID_SOCKET)
+			closesocket(data_listener);
+		return false;
+	}
+
+	_control_listener = static_cast<intptr_t>(control_listener);
+	_data_listener = static_cast<intptr_t>(data_listener);
+	_stop = false;
+	_control_thread = std::thread(&fake_camera::run_control, this);
+	_data_thread = std::thread(&fake_camera::run_data, this);
+
+	return true;
+}
+
+void benchmark::fake_camera::stop()
+{
+	if (!_control_thread.joinable() && !_data_thread.joinable())
+		return;
+
+	_stop = true;
+	if (_control_thread.joinable())
+		_control_thread.join();
+	if (_data_thread.joinable())
+		_data_thread.join();
+
+	closesocket(static_cast<socket_t>(_control_listener));
+	closesocket(static_cast<socket_t>(_data_listener));
+#ifdef _WIN32
+	::WSACleanup();
+#endif
+}
+
+const bool benchmark::fake_camera::sent_time(const uint32_t frame_number, std::chrono::steady_clock::time_point& time) const
+{
+	std::lock_guard<std::mutex> locker(_sent_mutex);
+	const sent_frame& sent = _sent[frame_number % sent_history];
+	if (sent.number != frame_number)
+		return false;
+
+	time = sent.time;
+	return true;
+}
+
+const uint64_t benchmark::fake_camera::frames_sent() const
+{
+	return _frames_sent;
+}
+
+/**
+ * @brief Pre-encodes a set of blobs showing a box moving over a flat floor.
+ *
+ * Only the frame number is patched per send, so the server costs next to nothing compared to the
+ * pipeline being measured.
+ */
+void benchmark::fake_camera::encode_blobs()
+{
+	const std::string xml = camera_xml(_config.width, _config.height);
+	const size_t num_pixels = static_cast<size_t>(_config.width) * static_cast<size_t>(_config.height);
+
+	// 2024-01-01 00:00:00.000 in device timestamp format
+	const uint64_t timestamp = (uint64_t(2024) << 47) | (uint64_t(1) << 43) | (uint64_t(1) << 38);
+
+	uint32_t noise = 12345u;
+	for (size_t blob_index = 0; blob_index < num_blobs; ++blob_index)
+	{
+		// distance map unit is 1/4 mm: floor at 2 m, box at 1.2 m
+		const int box_size = _config.height / 3;
+		const int box_x = static_cast<int>(blob_index * (_config.width - box_size) / num_blobs);
+		const int box_y = _config.height / 3;
+
+		std::vector<uint16_t> distance(num_pixels);
+		std::vector<uint16_t> intensity(num_pixels);
+		std::vector<uint16_t> state(num_pixels, 0);
+		for (int y = 0; y < _config.height; ++y)
+		{
+			for (int x = 0; x < _config.width; ++x)
+			{
+				noise = noise * 1664525u + 1013904223u;
+				const bool in_box = x >= box_x && x < box_x + box_size && y >= box_y && y < box_y + box_size;
+				const size_t i = static_cast<size_t>(y) * _config.width + x;
+				distance[i] = static_cast<uint16_t>((in_box ? 4800 : 8000) + (noise >> 28));
+				intensity[i] = static_cast<uint16_t>(in_box ? 900 : 400);
+				// roughly 1% dropouts
+				if ((noise >> 16) % 100 == 0)
+					distance[i] = 0;
+			}
+		}
+
+		std::vector<uint8_t> binary;
+		binary.reserve(4 + 8 + 2 + 6 + num_pixels * 6 + 8);
+		const uint32_t binary_length = static_cast<uint32_t>(4 + 8 + 2 + 6 + num_pixels * 6 + 8);
+		append_le<uint32_t>(binary, binary_length);
+		append_le<uint64_t>(binary, timestamp);
+		append_le<uint16_t>(binary, 2); // version 2 carries the frame number
+		append_le<uint32_t>(binary, 0); // frame number, patched when sent
+		append_le<uint8_t>(binary, 0);  // data quality
+		append_le<uint8_t>(binary, 0);  // device status
+		for (const auto* map : { &distance, &intensity, &state })
+			for (const uint16_t value : *map)
+				append_le<uint16_t>(binary, value);
+		append_le<uint32_t>(binary, 0); // crc, unused by the parser
+		append_le<uint32_t>(binary, binary_length);
+
+		// segment offsets are relative to the blob id field
+		constexpr uint32_t num_segments = 3;
+		const uint32_t xml_offset = 4 + num_segments * 8;
+		const uint32_t binary_offset = xml_offset + static_cast<uint32_t>(xml.size());
+		const uint32_t end_offset = binary_offset + static_cast<uint32_t>(binary.size());
+
+		std::vector<uint8_t> blob(8 + 3 + end_offset);
+		uint8_t* p = blob.data();
+		std::memset(p, 0x02, 4);
+		put_be32(p + 4, static_cast<uint32_t>(blob.size() - 8));
+		p[8] = 0x00; p[9] = 0x01;  // protocol version
+		p[10] = 0x62;              // packet type
+		p[11] = 0x00; p[12] = 0x00; // blob id
+		p[13] = 0x00; p[14] = static_cast<uint8_t>(num_segments);
+		const uint32_t offsets[num_segments] = { xml_offset, binary_offset, end_offset };
+		for (uint32_t s = 0; s < num_segments; ++s)
+		{
+			put_be32(p + 15 + s * 8, offsets[s]);
+			put_be32(p + 15 + s * 8 + 4, 1); // constant change counter, xml is parsed once
+		}
+		std::memcpy(p + 11 + xml_offset, xml.data(), xml.size());
+		std::memcpy(p + 11 + binary_offset, binary.data(), binary.size());
+
+		_frame_number_offset = 11 + binary_offset + 4 + 8 + 2;
+		_blobs.push_back(std::move(blob));
+	}
+}
+
+/**
+ * @brief Answers CoLa-2 requests. Session requests get a session id, everything else a success reply.
+ */
+void benchmark::fake_camera::run_control()
+{
+	const socket_t listener = static_cast<socket_t>(_control_listener);
+	while (!_stop)
+	{
+		if (!wait_readable(listener, accept_timeout_ms))
+			continue;
+
+		const socket_t client = ::accept(listener, nullptr, nullptr);
+		if (client == INVALID_SOCKET)
+			continue;
+
+		uint8_t header[8];
+		while (recv_all(client, header, sizeof(header), _stop))
+		{
+			const uint32_t length = (uint32_t(header[4]) << 24) | (uint32_t(header[5]) << 16) | (uint32_t(header[6]) << 8) | header[7];
+			std::vector<uint8_t> request(length);
+			if (length < 8 || !recv_all(client, request.data(), request.size(), _stop))
+				break;
+
+			// request: hub counter, noc, session id (4), request id (2), command
+			std::vector<uint8_t> response(8 + 8);
+			std::memset(response.data(), 0x02, 4);
+			std::memcpy(response.data() + 8, request.data(), 8);
+			put_be32(response.data() + 8 + 2, 1); // session id
+
+			const std::string command(request.begin() + 8, request.end());
+			if (command.rfind("Ox", 0) == 0)
+			{
+				response.insert(response.end(), { 'O', 'A' });
+			}
+			else
+			{
+				// "MN PLAYSTART" -> "AN PLAYSTART ", the trailing space terminates the name
+				const size_t name_start = command.find(' ');
+				const size_t name_end = command.find(' ', name_start == std::string::npos ? 0 : name_start + 1);
+				const std::string name = name_start == std::string::npos ? "" : command.substr(name_start + 1, name_end - name_start - 1);
+				const char type = command.size() > 0 && command[0] == 'R' ? 'R' : command.size() > 0 && command[0] == 'W' ? 'W' : 'A';
+				const std::string reply = type == 'A' ? "AN " + name + " " : std::string(1, type) + "A " + name + " ";
+				response.insert(response.end(), reply.begin(), reply.end());
+			}
+			put_be32(response.data() + 4, static_cast<uint32_t>(response.size() - 8));
+
+			if (!send_all(client, response.data(), response.size()))
+				break;
+		}
+
+		closesocket(client);
+	}
+}
+
+/**
+ * @brief Streams the pre-encoded blobs to a connected client at the configured frame rate.
+ */
+void benchmark::fake_camera::run_data()
+{
+	const socket_t listener = static_cast<socket_t>(_data_listener);
+	uint32_t frame_number = 0;
+	while (!_stop)
+	{
+		if (!wait_readable(listener, accept_timeout_ms))
+			continue;
+
+		const socket_t client = ::accept(listener, nullptr, nullptr);
+		if (client == INVALID_SOCKET)
+			continue;
+
+		const auto frame_period = _config.fps > 0.0
+			? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / _config.fps))
+			: std::chrono::steady_clock::duration::zero();
+		auto next_send = std::chrono::steady_clock::now();
+		while (!_stop)
+		{
+			++frame_number;
+			std::vector<uint8_t>& blob = _blobs[frame_number % num_blobs];
+			for (size_t i = 0; i < sizeof(uint32_t); ++i)
+				blob[_frame_number_offset + i] = static_cast<uint8_t>(frame_number >> (8 * i));
+
+			{
+				std::lock_guard<std::mutex> locker(_sent_mutex);
+				_sent[frame_number % sent_history] = { frame_number, std::chrono::steady_clock::now() };
+			}
+
+			if (!send_all(client, blob.data(), blob.size()))
+				break;
+			++_frames_sent;
+
+			if (frame_period != std::chrono::steady_clock::duration::zero())
+			{
+				next_send += frame_period;
+				std::this_thread::sleep_until(next_send);
+			}
+		}
+
+		closesocket(client);
+	}
+}
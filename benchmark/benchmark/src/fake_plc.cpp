@@ -0,0 +1,62 @@
+#include "benchmark/fake_plc.h"
+
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
+benchmark::fake_plc::fake_plc(const int db_number, const int db_size_bytes)
+	: db_number(db_number), db(db_size_bytes, 0), write_count(0), started(false)
+{
+}
+
+benchmark::fake_plc::~fake_plc()
+{
+	stop();
+}
+
+const bool benchmark::fake_plc::start(const std::string& ip)
+{
+	// snap7 areas are addressed with 16 bit sizes
+	if (db.size() > std::numeric_limits<word>::max())
+	{
+		spdlog::get("benchmark")->error("Data block of {} bytes exceeds the snap7 area limit", db.size());
+		return false;
+	}
+
+	server.RegisterArea(srvAreaDB, static_cast<word>(db_number), db.data(), static_cast<word>(db.size()));
+	server.SetEventsMask(evcDataWrite);
+	server.SetEventsCallback(&fake_plc::on_event, this);
+
+	const int ret = server.StartTo(ip.c_str());
+	if (ret != 0)
+	{
+		spdlog::get("benchmark")->error("Fake PLC failed to start on {}: {}", ip, SrvErrorText(ret));
+		return false;
+	}
+
+	started = true;
+	return true;
+}
+
+void benchmark::fake_plc::stop()
+{
+	if (!started)
+		return;
+
+	server.Stop();
+	server.UnregisterArea(srvAreaDB, static_cast<word>(db_number));
+	started = false;
+}
+
+const uint64_t benchmark::fake_plc::writes() const
+{
+	return write_count;
+}
+
+void S7API benchmark::fake_plc::on_event(void* usr, PSrvEvent event, int size)
+{
+	if (event->EvtCode == evcDataWrite && event->EvtRetCode == 0)
+	{
+		++static_cast<fake_plc*>(usr)->write_count;
+	}
+}
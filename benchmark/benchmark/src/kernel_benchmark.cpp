@@ -0,0 +1,110 @@
+#include "benchmark/kernel_benchmark.h"
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include "common/fixed_point_kernels.h"
+
+namespace
+{
+	/**
+	 * @brief Mean time of 'iterations' calls of 'function' in microseconds, after one untimed call.
+	 */
+	const double time_us(const std::function<void()>& function, const int iterations)
+	{
+		function();
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+			function();
+		const auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+	}
+
+	/**
+	 * @brief Smooth depth ramp with noise and about 5% invalid (zero) pixels.
+	 */
+	const cv::Mat synthetic_depth(const int width, const int height)
+	{
+		std::mt19937 random(42);
+		std::normal_distribution<double> noise(0.0, 15.0);
+		std::uniform_real_distribution<double> dropout(0.0, 1.0);
+
+		cv::Mat depth(height, width, CV_16UC1);
+		for (int y = 0; y < height; ++y)
+		{
+			uint16_t* row = depth.ptr<uint16_t>(y);
+			for (int x = 0; x < width; ++x)
+			{
+				const double value = 1000.0 + 2.0 * x + 3.0 * y + noise(random);
+				row[x] = dropout(random) < 0.05 ? 0 : cv::saturate_cast<uint16_t>(value);
+			}
+		}
+
+		return depth;
+	}
+
+	const double max_difference(const cv::Mat& a, const cv::Mat& b)
+	{
+		cv::Mat difference;
+		cv::absdiff(a, b, difference);
+
+		double max = 0.0;
+		cv::minMaxLoc(difference, nullptr, &max);
+		return max;
+	}
+}
+
+const nlohmann::json benchmark::run_kernel_benchmark(const int width, const int height, const int iterations)
+{
+	const cv::Mat input = synthetic_depth(width, height);
+	nlohmann::json results = nlohmann::json::array();
+
+	for (const int size : { 3, 5, 7 })
+	{
+		const cv::Size kernel_size(size, size);
+		cv::Mat reference, fixed_point;
+
+		struct kernel_case
+		{
+			std::string name;
+			std::function<void()> opencv;
+			std::function<void()> fixed;
+		};
+
+		const kernel_case cases[] = {
+			{ "blur",
+				[&]() { cv::blur(input, reference, kernel_size); },
+				[&]() { kernels::box_blur(input, fixed_point, kernel_size); } },
+			{ "gaussian-blur",
+				[&]() { cv::GaussianBlur(input, reference, kernel_size, 0.0, 0.0); },
+				[&]() { kernels::gaussian_blur(input, fixed_point, kernel_size, 0.0, 0.0); } },
+			{ "stack-blur",
+				[&]() { cv::stackBlur(input, reference, kernel_size); },
+				[&]() { kernels::stack_blur(input, fixed_point, kernel_size); } },
+		};
+
+		for (const kernel_case& c : cases)
+		{
+			const double opencv_us = time_us(c.opencv, iterations);
+			const double fixed_us = time_us(c.fixed, iterations);
+
+			results.push_back({
+				{ "kernel", c.name },
+				{ "size", size },
+				{ "opencv_us", opencv_us },
+				{ "fixed_point_us", fixed_us },
+				{ "speedup", fixed_us > 0.0 ? opencv_us / fixed_us : 0.0 },
+				{ "max_difference", max_difference(reference, fixed_point) }
+			});
+		}
+	}
+
+	return results;
+}
@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "CLI11.hpp"
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#define JSON_USE_IMPLICIT_CONVERSIONS 0
+#include "json.hpp"
+
+#include "common/filter_pipeline.h"
+#include "common/camera_handler.h"
+#include "common/plc_handler.h"
+#include "common/processing_loop.h"
+
+#include "benchmark/fake_camera.h"
+#include "benchmark/fake_plc.h"
+#include "benchmark/kernel_benchmark.h"
+#include "benchmark/point_cloud_benchmark.h"
+
+#include "opencv2/core/utils/logger.hpp"
+
+volatile std::atomic_bool done = false;
+
+void setup_loggers();
+const bool parse_filters(const std::string& path, filter::filter_pipeline& pipeline);
+const bool parse_zones(const std::string& path, std::vector<zones::zone>& parsed);
+const double process_cpu_ms();
+const double percentile(const std::vector<double>& sorted, const double p);
+
+/**
+ * @brief Runs the headless processing loop against a localhost camera and PLC stand-in and reports
+ * throughput, end-to-end latency and CPU cost per frame.
+ */
+int main(int argc, char** argv)
+{
+	setup_loggers();
+
+	CLI::App app{ "End-to-end throughput benchmark of the camera -> filter -> PLC loop" };
+
+	int frames = 1000;
+	app.add_option("--frames", frames, "Number of measured frames")->check(CLI::PositiveNumber);
+
+	int warmup = 50;
+	app.add_option("--warmup", warmup, "Number of frames processed before measuring")->check(CLI::NonNegativeNumber);
+
+	double fps = 30.0;
+	app.add_option("--fps", fps, "Camera frame rate, 0 sends as fast as possible")->check(CLI::NonNegativeNumber);
+
+	int width = 512;
+	app.add_option("--width", width, "Camera image width")->check(CLI::PositiveNumber);
+
+	int height = 424;
+	app.add_option("--height", height, "Camera image height")->check(CLI::PositiveNumber);
+
+	int frame_width = 10;
+	app.add_option("--frame-width", frame_width, "Width of the frame written to the PLC")->check(CLI::PositiveNumber);
+
+	int frame_height = 10;
+	app.add_option("--frame-height", frame_height, "Height of the frame written to the PLC")->check(CLI::PositiveNumber);
+
+	uint16_t port = 2114;
+	app.add_option("--port", port, "Camera data port");
+
+	std::string encoding = "udint";
+	app.add_option("--encoding", encoding, "PLC data type per pixel")->check(CLI::IsMember({ "udint", "uint", "bits" }));
+
+	int db_number = 1;
+	app.add_option("--db", db_number, "PLC data block number")->check(CLI::PositiveNumber);
+
+	std::string filter_path = "";
+	app.add_option("--filters", filter_path, "Path to filter file")->expected(1);
+
+	std::string zones_path = "";
+	app.add_option("--zones", zones_path, "Path to a JSON array of zones, as in the 'zones' section of the headless configuration. Sends zone states instead of the frame")->expected(1);
+
+	bool zone_distances = false;
+	app.add_flag("--zone-distances", zone_distances, "Send the distance of the nearest pixel of every zone after the occupied bits")->needs("--zones");
+
+	std::string json_path = "";
+	app.add_option("--json", json_path, "Write results as JSON to this path")->expected(1);
+
+	double min_fps = 0.0;
+	app.add_option("--min-fps", min_fps, "Fail if throughput is below this many frames per second");
+
+	double max_p99_ms = 0.0;
+	app.add_option("--max-p99-ms", max_p99_ms, "Fail if 99th percentile latency exceeds this many milliseconds");
+
+	bool kernels = false;
+	app.add_flag("--kernels", kernels, "Time the fixed point blur kernels against OpenCV on a --width x --height image instead of running the loop");
+
+	int kernel_iterations = 1000;
+	app.add_option("--kernel-iterations", kernel_iterations, "Calls timed per kernel with --kernels and --point-cloud")->check(CLI::PositiveNumber);
+
+	bool point_cloud = false;
+	app.add_flag("--point-cloud", point_cloud, "Time the point cloud conversion against the scalar version on a --width x --height image instead of running the loop")->excludes("--kernels");
+
+	CLI11_PARSE(app, argc, argv);
+
+	if (kernels || point_cloud)
+	{
+		const nlohmann::json results = kernels
+			? benchmark::run_kernel_benchmark(width, height, kernel_iterations)
+			: benchmark::run_point_cloud_benchmark(width, height, kernel_iterations);
+		std::cout << results.dump(2) << "\n";
+		if (!json_path.empty())
+		{
+			std::ofstream(json_path) << results.dump(2) << "\n";
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	filter::filter_pipeline pipeline;
+	if (app.count("--filters") > 0 && !parse_filters(filter_path, pipeline))
+	{
+		return EXIT_FAILURE;
+	}
+
+	processing::loop_config loop_config;
+	loop_config.db_number = db_number;
+	loop_config.db_offset_bytes = 0;
+	loop_config.frame_width = frame_width;
+	loop_config.frame_height = frame_height;
+	plc::parse_encoding(encoding, loop_config.encoding);
+	if (app.count("--zones") > 0 && !parse_zones(zones_path, loop_config.zones))
+	{
+		return EXIT_FAILURE;
+	}
+	loop_config.zone_distances = zone_distances;
+
+	const std::string ip = "127.0.0.1";
+
+	// the data block is exactly as large as the PLC would declare it, so a layout mismatch fails the writes
+	const size_t frame_bytes = processing::frame_size_bytes(loop_config);
+	benchmark::fake_plc fake_plc(db_number, static_cast<int>(frame_bytes));
+	if (!fake_plc.start(ip))
+	{
+		return EXIT_FAILURE;
+	}
+
+	benchmark::fake_camera_config camera_config;
+	camera_config.ip = ip;
+	camera_config.data_port = port;
+	camera_config.width = width;
+	camera_config.height = height;
+	camera_config.fps = fps;
+	benchmark::fake_camera fake_camera(camera_config);
+	if (!fake_camera.start())
+	{
+		return EXIT_FAILURE;
+	}
+
+	plc::plc_handler plc;
+	if (plc.connect_to(ip, 0, 1) != 0)
+	{
+		spdlog::get("benchmark")->error("Failed to connect to fake PLC");
+		return EXIT_FAILURE;
+	}
+
+	camera::camera_handler camera;
+	if (!camera.open(ip, port, 1000))
+	{
+		spdlog::get("benchmark")->error("Failed to open fake camera");
+		return EXIT_FAILURE;
+	}
+
+	processing::processing_loop loop(camera, plc, pipeline, loop_config);
+
+	// latencies are measured from the fake camera sending a frame to the PLC write of that frame returning.
+	// frames skipped as unchanged count as processed but have no latency
+	std::vector<double> latencies_ms;
+	latencies_ms.reserve(frames);
+	std::atomic_int processed = 0;
+	int skipped = 0;
+	uint32_t first_frame = 0, last_frame = 0;
+	std::chrono::steady_clock::time_point start_time, end_time;
+	double start_cpu_ms = 0.0, end_cpu_ms = 0.0;
+
+	std::mutex progress_mutex;
+	std::condition_variable progress_cv;
+
+	// called from the filter stage for skipped frames and from the write stage for written ones
+	const auto frame_done = [&](const uint32_t frame_number, const bool written)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			{
+				std::lock_guard<std::mutex> locker(progress_mutex);
+				const int count = ++processed;
+				if (count == warmup + 1)
+				{
+					start_time = now;
+					start_cpu_ms = process_cpu_ms();
+					first_frame = frame_number;
+				}
+				if (count > warmup && count <= warmup + frames)
+				{
+					std::chrono::steady_clock::time_point sent;
+					if (!written)
+						++skipped;
+					else if (fake_camera.sent_time(frame_number, sent))
+						latencies_ms.push_back(std::chrono::duration<double, std::milli>(now - sent).count());
+
+					last_frame = frame_number;
+				}
+				if (count == warmup + frames)
+				{
+					end_time = now;
+					end_cpu_ms = process_cpu_ms();
+					done = true;
+				}
+			}
+			progress_cv.notify_all();
+		};
+	loop.set_frame_written_callback([&](const uint32_t frame_number) { frame_done(frame_number, true); });
+	loop.set_frame_skipped_callback([&](const uint32_t frame_number) { frame_done(frame_number, false); });
+
+	// stop the loop if the camera stalls instead of hanging indefinitely. wakes up on every processed frame,
+	// so it neither delays the end of the run nor mistakes skipped frames for a stall
+	const auto frame_budget = std::chrono::milliseconds(fps > 0.0 ? static_cast<int>(4000.0 / fps) + 5000 : 5000);
+	std::thread watchdog([&]()
+		{
+			std::unique_lock<std::mutex> locker(progress_mutex);
+			while (!done)
+			{
+				const int last_processed = processed;
+				if (!progress_cv.wait_for(locker, frame_budget, [&]() { return done || processed != last_processed; }))
+				{
+					spdlog::get("benchmark")->error("No frame processed for {} ms, aborting", frame_budget.count());
+					done = true;
+				}
+			}
+		});
+
+	const bool loop_ok = loop.run(done);
+	{
+		// the loop may also stop on an error
+		std::lock_guard<std::mutex> locker(progress_mutex);
+		done = true;
+	}
+	progress_cv.notify_all();
+	watchdog.join();
+	fake_camera.stop();
+	fake_plc.stop();
+
+	if (!loop_ok || processed < warmup + frames)
+	{
+		spdlog::get("benchmark")->error("Benchmark did not complete: {} of {} frames processed", processed.load(), warmup + frames);
+		return EXIT_FAILURE;
+	}
+
+	std::sort(latencies_ms.begin(), latencies_ms.end());
+	const double elapsed_s = std::chrono::duration<double>(end_time - start_time).count();
+	const double throughput = elapsed_s > 0.0 ? (frames - 1) / elapsed_s : 0.0;
+	const double cpu_ms_per_frame = (end_cpu_ms - start_cpu_ms) / frames;
+	const uint32_t dropped = (last_frame - first_frame + 1) - static_cast<uint32_t>(frames);
+
+	nlohmann::json results;
+	results["frames"] = frames;
+	results["camera"] = { { "width", width }, { "height", height }, { "fps", fps } };
+	results["plc_frame"] = { { "width", frame_width }, { "height", frame_height }, { "encoding", encoding }, { "zones", loop_config.zones.size() }, { "bytes", frame_bytes } };
+	results["filters"] = pipeline.to_json();
+	results["throughput_fps"] = throughput;
+	results["latency_ms"] = {
+		{ "p50", percentile(latencies_ms, 0.50) },
+		{ "p90", percentile(latencies_ms, 0.90) },
+		{ "p99", percentile(latencies_ms, 0.99) },
+		{ "max", latencies_ms.empty() ? 0.0 : latencies_ms.back() }
+	};
+	results["cpu_ms_per_frame"] = cpu_ms_per_frame;
+	results["dropped_frames"] = dropped;
+	results["skipped_frames"] = skipped;
+	results["plc_writes"] = fake_plc.writes();
+
+	std::cout << results.dump(2) << "\n";
+	if (!json_path.empty())
+	{
+		std::ofstream(json_path) << results.dump(2) << "\n";
+	}
+
+	bool passed = true;
+	if (min_fps > 0.0 && throughput < min_fps)
+	{
+		spdlog::get("benchmark")->error("Throughput {:.1f} fps below required {:.1f} fps", throughput, min_fps);
+		passed = false;
+	}
+	if (max_p99_ms > 0.0 && percentile(latencies_ms, 0.99) > max_p99_ms)
+	{
+		spdlog::get("benchmark")->error("p99 latency {:.2f} ms above allowed {:.2f} ms", percentile(latencies_ms, 0.99), max_p99_ms);
+		passed = false;
+	}
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Creates logger objects and sets logging levels.
+ *
+ * Only warnings and errors are logged so console output does not skew the measurement.
+ */
+void setup_loggers()
+{
+	std::vector<spdlog::sink_ptr> sinks;
+	sinks.push_back(std::make_shared<spdlog::sinks::stderr_color_sink_mt>());
+
+	static constexpr char const* log_names[] = {
+		"benchmark",
+		"app",
+		"camera",
+		"filter",
+		"plc",
+		"sickapi"
+	};
+
+	for (const char* log_name : log_names)
+	{
+		spdlog::register_logger(std::make_shared<spdlog::logger>((log_name), sinks.begin(), sinks.end()));
+	}
+
+	spdlog::set_default_logger(spdlog::get(log_names[0]));
+	spdlog::set_level(spdlog::level::warn);
+	cv::utils::logging::setLogLevel(cv::utils::logging::LOG_LEVEL_ERROR);
+}
+
+/**
+ * @brief Reads JSON filter file.
+ *
+ * @param path Path to JSON file containing filter definitions
+ * @param pipeline Output filter pipeline constructed from parsed filters
+ * @return True if successful, false otherwise
+ */
+const bool parse_filters(const std::string& path, filter::filter_pipeline& pipeline)
+{
+	try
+	{
+		nlohmann::json filters = nlohmann::json::parse(std::ifstream(path));
+		pipeline.load_json(filters);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Exception while parsing filter file: " << e.what() << "\n";
+		return false;
+	}
+	catch (...)
+	{
+		std::cerr << "Unknown exception while parsing filter file\n";
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Reads a JSON file holding an array of zones.
+ *
+ * @param path Path to JSON file containing zone definitions
+ * @param parsed Parsed zones
+ * @return True if successful, false otherwise
+ */
+const bool parse_zones(const std::string& path, std::vector<zones::zone>& parsed)
+{
+	try
+	{
+		return zones::parse_zones(nlohmann::json::parse(std::ifstream(path)), parsed);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Exception while parsing zone file: " << e.what() << "\n";
+		return false;
+	}
+	catch (...)
+	{
+		std::cerr << "Unknown exception while parsing zone file\n";
+		return false;
+	}
+}
+
+/**
+ * @brief CPU time consumed by all threads of this process.
+ *
+ * @return CPU time in milliseconds
+ */
+const double process_cpu_ms()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0.0;
+
+	const auto to_100ns = [](const FILETIME& time) { return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+	return (to_100ns(kernel) + to_100ns(user)) / 10000.0;
+#else
+	return 1000.0 * static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * @brief Nearest-rank percentile.
+ *
+ * @param sorted Ascending values
+ * @param p Percentile in [0, 1]
+ * @return Value at percentile, 0 if empty
+ */
+const double percentile(const std::vector<double>& sorted, const double p)
+{
+	if (sorted.empty())
+		return 0.0;
+
+	const size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(rank, sorted.size() - 1)];
+}
@@ -0,0 +1,221 @@
+#include "benchmark/point_cloud_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "VisionaryData.h"
+
+namespace
+{
+	/**
+	 * @brief Distance image with fixed camera parameters, fed straight into the point cloud conversion
+	 * without a device or blob parsing.
+	 */
+	class synthetic_data : public visionary::VisionaryData
+	{
+	public:
+		synthetic_data(const int width, const int height)
+		{
+			m_cameraParams.width = width;
+			m_cameraParams.height = height;
+			m_cameraParams.fx = m_cameraParams.fy = 0.6 * width;
+			m_cameraParams.cx = width / 2.0;
+			m_cameraParams.cy = height / 2.0;
+			m_cameraParams.k1 = -0.05;
+			m_cameraParams.k2 = 0.01;
+			m_cameraParams.f2rc = 0.5;
+			m_scaleZ = 0.25f;
+
+			// camera 2.5 m above the floor looking down, tilted by 30 degrees
+			const double angle = 30.0 * 3.14159265358979 / 180.0;
+			const double cam2world[16] = {
+				1.0, 0.0, 0.0, 100.0,
+				0.0, -std::sin(angle), -std::cos(angle), 200.0,
+				0.0, std::cos(angle), -std::sin(angle), 2500.0,
+				0.0, 0.0, 0.0, 1.0
+			};
+			std::copy(cam2world, cam2world + 16, m_cameraParams.cam2worldMatrix);
+
+			std::mt19937 random(42);
+			std::uniform_int_distribution<int> distance(500, 20000);
+			std::uniform_real_distribution<double> dropout(0.0, 1.0);
+
+			// about 5% invalid pixels, split between 0 and the saturated value
+			map.resize(static_cast<size_t>(width) * height);
+			for (uint16_t& value : map)
+			{
+				const double invalid = dropout(random);
+				value = invalid < 0.025 ? 0 : invalid < 0.05 ? uint16_t(0xFFFF) : static_cast<uint16_t>(distance(random));
+			}
+		}
+
+		void generatePointCloud(std::vector<visionary::PointXYZ>& pointCloud) override
+		{
+			VisionaryData::generatePointCloud(map, VisionaryData::RADIAL, pointCloud);
+		}
+
+		void generateWorldPointCloud(std::vector<visionary::PointXYZ>& pointCloud) override
+		{
+			VisionaryData::generateWorldPointCloud(map, VisionaryData::RADIAL, pointCloud);
+		}
+
+		/**
+		 * @brief The previous look-up table: computed in double precision into an array of structures.
+		 */
+		void precalc_scalar(std::vector<visionary::PointXYZ>& table) const
+		{
+			const visionary::CameraParameters& p = m_cameraParams;
+			table.clear();
+			for (int row = 0; row < p.height; ++row)
+			{
+				const double yp = (p.cy - row) / p.fy;
+				for (int col = 0; col < p.width; ++col)
+				{
+					const double xp = (p.cx - col) / p.fx;
+					const double r2 = xp * xp + yp * yp;
+					const double k = 1 + p.k1 * r2 + p.k2 * r2 * r2;
+					const auto x = static_cast<float>(xp * k);
+					const auto y = static_cast<float>(yp * k);
+					const double s0 = std::sqrt(x * x + y * y + 1.0f) * 1000;
+					table.push_back({ static_cast<float>(x / s0), static_cast<float>(y / s0), static_cast<float>(1.0 / s0) });
+				}
+			}
+		}
+
+		/**
+		 * @brief The previous conversion: one pixel at a time from an array of structures look-up table with
+		 * a branch on invalid values.
+		 */
+		void generate_scalar(std::vector<visionary::PointXYZ>& pointCloud)
+		{
+			if (lut.empty())
+				precalc_scalar(lut);
+
+			const float bad_point = std::numeric_limits<float>::quiet_NaN();
+			const auto f2rc = static_cast<float>(m_cameraParams.f2rc / 1000.f);
+
+			pointCloud.resize(map.size());
+			for (size_t i = 0; i < map.size(); ++i)
+			{
+				if (map[i] == 0 || map[i] == uint16_t(0xFFFF))
+				{
+					pointCloud[i] = { bad_point, bad_point, bad_point };
+				}
+				else
+				{
+					const float distance = static_cast<float>(map[i]) * m_scaleZ;
+					pointCloud[i] = { lut[i].x * distance, lut[i].y * distance, lut[i].z * distance - f2rc };
+				}
+			}
+		}
+
+		const visionary::CameraParameters& parameters() const
+		{
+			return m_cameraParams;
+		}
+
+		bool parseXML(const std::string&, uint32_t) override
+		{
+			return false;
+		}
+
+		bool parseBinaryData(std::vector<uint8_t>::iterator, size_t) override
+		{
+			return false;
+		}
+
+	private:
+		std::vector<uint16_t> map;
+		std::vector<visionary::PointXYZ> lut;
+	};
+
+	/**
+	 * @brief Mean time of 'iterations' calls of 'function' in microseconds, after one untimed call.
+	 */
+	const double time_us(const std::function<void()>& function, const int iterations)
+	{
+		function();
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+			function();
+		const auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+	}
+
+	/**
+	 * @brief Largest coordinate difference between two clouds, or infinity if they differ in size or in
+	 * which points are invalid.
+	 */
+	const double max_difference(const std::vector<visionary::PointXYZ>& a, const std::vector<visionary::PointXYZ>& b)
+	{
+		if (a.size() != b.size())
+			return std::numeric_limits<double>::infinity();
+
+		double max = 0.0;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (std::isnan(a[i].x) != std::isnan(b[i].x))
+				return std::numeric_limits<double>::infinity();
+			if (std::isnan(a[i].x))
+				continue;
+
+			max = std::max({ max, std::abs(double(a[i].x) - b[i].x), std::abs(double(a[i].y) - b[i].y), std::abs(double(a[i].z) - b[i].z) });
+		}
+
+		return max;
+	}
+}
+
+const nlohmann::json benchmark::run_point_cloud_benchmark(const int width, const int height, const int iterations)
+{
+	synthetic_data data(width, height);
+	const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<visionary::PointXYZ> scalar, single, multi, two_pass, fused;
+
+	const double scalar_us = time_us([&]() { data.generate_scalar(scalar); }, iterations);
+
+	data.setPointCloudThreads(1);
+	const double single_us = time_us([&]() { data.generatePointCloud(single); }, iterations);
+
+	data.setPointCloudThreads(threads);
+	const double multi_us = time_us([&]() { data.generatePointCloud(multi); }, iterations);
+
+	data.setPointCloudThreads(1);
+	const double two_pass_us = time_us([&]() { data.generatePointCloud(two_pass); data.transformPointCloud(two_pass); }, iterations);
+	const double fused_us = time_us([&]() { data.generateWorldPointCloud(fused); }, iterations);
+
+	// a slightly different camera every call so the shared look-up table cache never hits
+	std::vector<visionary::PointXYZ> scalar_lut;
+	visionary::CameraParameters uncached = data.parameters();
+	const double lut_scalar_us = time_us([&]() { data.precalc_scalar(scalar_lut); }, iterations);
+	const double lut_us = time_us([&]() { uncached.cx += 1e-6; visionary::getUndistortionLut(uncached, true); }, iterations);
+	const double lut_cached_us = time_us([&]() { visionary::getUndistortionLut(data.parameters(), true); }, iterations);
+
+	return {
+		{ "points", scalar.size() },
+		{ "threads", threads },
+		{ "scalar_us", scalar_us },
+		{ "vectorized_us", single_us },
+		{ "vectorized_threaded_us", multi_us },
+		{ "speedup", single_us > 0.0 ? scalar_us / single_us : 0.0 },
+		{ "threaded_speedup", multi_us > 0.0 ? scalar_us / multi_us : 0.0 },
+		{ "max_difference", std::max(max_difference(scalar, single), max_difference(scalar, multi)) },
+		{ "world_two_pass_us", two_pass_us },
+		{ "world_fused_us", fused_us },
+		{ "world_speedup", fused_us > 0.0 ? two_pass_us / fused_us : 0.0 },
+		{ "world_max_difference", max_difference(two_pass, fused) },
+		{ "lut_scalar_us", lut_scalar_us },
+		{ "lut_vectorized_us", lut_us },
+		{ "lut_cached_us", lut_cached_us },
+		{ "lut_speedup", lut_us > 0.0 ? lut_scalar_us / lut_us : 0.0 }
+	};
+}
@@ -9,7 +9,9 @@
 
 #include "PointCloudPlyWriter.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include "VisionaryEndian.h"
@@ -34,6 +36,11 @@ bool PointCloudPlyWriter::WriteFormatPLY(const char* filename, const std::vector
 
 bool PointCloudPlyWriter::WriteFormatPLY(const char* filename, const std::vector<PointXYZ>& points, const std::vector<uint32_t>& rgbaMap, const std::vector<uint16_t>& intensityMap, bool useBinary, InvalidPointPresentation presentation)
 {
+  if (useBinary)
+  {
+    return writeBinaryPLY(filename, points, rgbaMap, intensityMap, presentation);
+  }
+
   bool success = true;
 
   bool hasColors = points.size() == rgbaMap.size();
@@ -47,30 +54,52 @@ bool PointCloudPlyWriter::WriteFormatPLY(const char* filename, const std::vector
                                //         therefore the data part has to be temprorarily buffered.
   
   int numberOfValidPoints = 0;
-  if (useBinary == false)
+  // Write all points
+  for (size_t i = 0; i < points.size(); i++)
   {
-    // Write all points
-    for (size_t i = 0; i < points.size(); i++)
+    PointXYZ point = points.at(i);
+
+    // Handle PLY file presentation of X Y Z values (nan, 0.0 or SKIP)
+    if (presentation == INVALID_AS_NAN)
     {
-      PointXYZ point = points.at(i);
+      strstream << point.x << " " << point.y << " " << point.z;
+    }
+    if (presentation == INVALID_AS_ZERO)
+    {
+      if (std::isnan(point.x)) strstream << "0.0"; else strstream << point.x;
+      strstream << " ";
+
+      if (std::isnan(point.y)) strstream << "0.0"; else strstream << point.y;
+      strstream << " ";
 
-      // Handle PLY file presentation of X Y Z values (nan, 0.0 or SKIP)
-      if (presentation == INVALID_AS_NAN)
+      if (std::isnan(point.z)) strstream << "0.0"; else strstream << point.z;
+    }
+    if (presentation == INVALID_AS_NAN || presentation == INVALID_AS_ZERO)
+    {
+      if (hasColors)
       {
-        strstream << point.x << " " << point.y << " " << point.z;
+        const auto rgba = reinterpret_cast<const uint8_t*>(&rgbaMap.at(i));
+        strstream << " " << static_cast<uint32_t>(rgba[0]) << " " << static_cast<uint32_t>(rgba[1]) << " " << static_cast<uint32_t>(rgba[2]);
       }
-      if (presentation == INVALID_AS_ZERO)
+      if (hasIntensities)
       {
-        if (std::isnan(point.x)) strstream << "0.0"; else strstream << point.x;
-        strstream << " ";
-
-        if (std::isnan(point.y)) strstream << "0.0"; else strstream << point.y;
-        strstream << " ";
-
-        if (std::isnan(point.z)) strstream << "0.0"; else strstream << point.z;
+        float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
+        strstream << " " << intensity;
+      }
+      strstream << "\n";
+    }
+    if (presentation == INVALID_SKIP)
+    {
+      // The X and Y values are calculated using the Z/distance value which is received by the device. 
+      // So X and Y should only be NaN if Z/distance is NaN.
+      if (std::isnan(point.z))
+      {
+        continue;
       }
-      if (presentation == INVALID_AS_NAN || presentation == INVALID_AS_ZERO)
+      else
       {
+        strstream << point.x << " " << point.y << " " << point.z;
+
         if (hasColors)
         {
           const auto rgba = reinterpret_cast<const uint8_t*>(&rgbaMap.at(i));
@@ -82,153 +111,159 @@ bool PointCloudPlyWriter::WriteFormatPLY(const char* filename, const std::vector
           strstream << " " << intensity;
         }
         strstream << "\n";
-      }
-      if (presentation == INVALID_SKIP)
-      {
-        // The X and Y values are calculated using the Z/distance value which is received by the device. 
-        // So X and Y should only be NaN if Z/distance is NaN.
-        if (std::isnan(point.z))
-        {
-          continue;
-        }
-        else
-        {
-          strstream << point.x << " " << point.y << " " << point.z;
-
-          if (hasColors)
-          {
-            const auto rgba = reinterpret_cast<const uint8_t*>(&rgbaMap.at(i));
-            strstream << " " << static_cast<uint32_t>(rgba[0]) << " " << static_cast<uint32_t>(rgba[1]) << " " << static_cast<uint32_t>(rgba[2]);
-          }
-          if (hasIntensities)
-          {
-            float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-            strstream << " " << intensity;
-          }
-          strstream << "\n";
-
-          numberOfValidPoints++;
-        }
+
+        numberOfValidPoints++;
       }
     }
   }
+
+  // Open file
+  stream.open(filename, std::ios_base::out);
+
+  if (stream.is_open())
+  {
+    // Write header
+    stream << plyHeader(presentation == INVALID_SKIP ? static_cast<size_t>(numberOfValidPoints) : points.size(), false, hasColors, hasIntensities);
+  }
   else
   {
-    // Write all points
-    for (size_t i = 0; i < points.size(); i++)
-    {
-      PointXYZ point = points.at(i);
+    success = false;
+  }
 
-      // Handle PLY file presentation of X Y Z values (nan, 0.0 or SKIP)
-      if (presentation == INVALID_AS_NAN)
-      {
-        // Nothing to do, use values as they are available
-      }
-      if (presentation == INVALID_AS_ZERO)
-      {
-        if (std::isnan(point.x)) point.x = 0.0f;
-        if (std::isnan(point.y)) point.y = 0.0f;
-        if (std::isnan(point.z)) point.z = 0.0f;
-      }
-      if (presentation == INVALID_AS_NAN || presentation == INVALID_AS_ZERO)
-      {
-        float x = nativeToLittleEndian(point.x);
-        float y = nativeToLittleEndian(point.y);
-        float z = nativeToLittleEndian(point.z);
+  // Add the temporarily buffered data part to the ofstream
+  stream << strstream.rdbuf();
 
-        strstream.write(reinterpret_cast<char*>(&x), 4);
-        strstream.write(reinterpret_cast<char*>(&y), 4);
-        strstream.write(reinterpret_cast<char*>(&z), 4);
+  // Close file
+  stream.close();
 
-        if (hasColors)
-        {
-          strstream.write(reinterpret_cast<const char*>(&rgbaMap.at(i)), 3);
-        }
-        if (hasIntensities)
-        {
-          float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-          strstream.write(reinterpret_cast<const char*>(&intensity), 4);
-        }
-      }
-      if (presentation == INVALID_SKIP)
-      {
-        // The X and Y values are calculated using the Z/distance value which is received by the device. 
-        // So X and Y should only be NaN if Z/distance is NaN.
-        if (std::isnan(point.z))
-        {
-          continue;
-        }
-        else
-        {
-          float x = nativeToLittleEndian(point.x);
-          float y = nativeToLittleEndian(point.y);
-          float z = nativeToLittleEndian(point.z);
-
-          strstream.write(reinterpret_cast<char*>(&x), 4);
-          strstream.write(reinterpret_cast<char*>(&y), 4);
-          strstream.write(reinterpret_cast<char*>(&z), 4);
-
-          if (hasColors)
-          {
-            strstream.write(reinterpret_cast<const char*>(&rgbaMap.at(i)), 3);
-          }
-          if (hasIntensities)
-          {
-            float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-            strstream.write(reinterpret_cast<const char*>(&intensity), 4);
-          }
-          
-          numberOfValidPoints++;
-        }
-      }
-    }
+  return success;
+}
+
+bool PointCloudPlyWriter::WriteFormatRaw(const char* filename, const std::vector<PointXYZ>& points, InvalidPointPresentation presentation)
+{
+  std::vector<char> buffer;
+  appendRawPoints(points, presentation, buffer);
+
+  return writeFile(filename, buffer);
+}
+
+bool PointCloudPlyWriter::writeBinaryPLY(const char* filename, const std::vector<PointXYZ>& points, const std::vector<uint32_t>& rgbaMap, const std::vector<uint16_t>& intensityMap, InvalidPointPresentation presentation)
+{
+  const bool hasColors = points.size() == rgbaMap.size();
+  const bool hasIntensities = points.size() == intensityMap.size();
+
+  // X and Y are only NaN if Z/distance is NaN, see the ascii writer
+  size_t numberOfPoints = points.size();
+  if (presentation == INVALID_SKIP)
+  {
+    numberOfPoints = static_cast<size_t>(std::count_if(points.begin(), points.end(), [](const PointXYZ& point) { return !std::isnan(point.z); }));
   }
 
-  // Open file
-  stream.open(filename, useBinary ? (std::ios_base::out | std::ios_base::binary) : std::ios_base::out);
+  // assemble the whole file in one buffer so it is written with a single call
+  const std::string header = plyHeader(numberOfPoints, true, hasColors, hasIntensities);
+  const size_t vertexSize = 3u * sizeof(float) + (hasColors ? 3u : 0u) + (hasIntensities ? sizeof(float) : 0u);
+  std::vector<char> buffer(header.size() + numberOfPoints * vertexSize);
+  std::memcpy(buffer.data(), header.data(), header.size());
 
-  if (stream.is_open())
+  char* out = buffer.data() + header.size();
+  const auto writeFloat = [&out](float value)
   {
-    // Write header
-    stream << "ply\n";
-    stream << "format " << (useBinary ? "binary_little_endian" : "ascii") << " 1.0\n";
+    value = nativeToLittleEndian(value);
+    std::memcpy(out, &value, sizeof(float));
+    out += sizeof(float);
+  };
 
-    if (presentation == INVALID_SKIP)
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    PointXYZ point = points[i];
+    if (presentation == INVALID_SKIP && std::isnan(point.z))
     {
-      stream << "element vertex " << numberOfValidPoints << "\n";
+      continue;
     }
-    else
+    if (presentation == INVALID_AS_ZERO)
     {
-      stream << "element vertex " << points.size() << "\n";
+      if (std::isnan(point.x)) point.x = 0.0f;
+      if (std::isnan(point.y)) point.y = 0.0f;
+      if (std::isnan(point.z)) point.z = 0.0f;
     }
 
-    stream << "property float x\n";
-    stream << "property float y\n";
-    stream << "property float z\n";
+    writeFloat(point.x);
+    writeFloat(point.y);
+    writeFloat(point.z);
     if (hasColors)
     {
-      stream << "property uchar red\n";
-      stream << "property uchar green\n";
-      stream << "property uchar blue\n";
+      std::memcpy(out, &rgbaMap[i], 3u);
+      out += 3u;
     }
     if (hasIntensities)
     {
-      stream << "property float intensity\n";
+      writeFloat(static_cast<float>(intensityMap[i]) / 65535.0f);
     }
-    stream << "end_header\n";
   }
-  else
+
+  return writeFile(filename, buffer);
+}
+
+void PointCloudPlyWriter::appendRawPoints(const std::vector<PointXYZ>& points, InvalidPointPresentation presentation, std::vector<char>& buffer)
+{
+  const size_t offset = buffer.size();
+  buffer.resize(offset + points.size() * 3u * sizeof(float));
+
+  char* out = buffer.data() + offset;
+  for (const PointXYZ& point : points)
   {
-    success = false;
+    if (presentation == INVALID_SKIP && std::isnan(point.z))
+    {
+      continue;
+    }
+
+    const bool zero = presentation == INVALID_AS_ZERO;
+    const float xyz[3] = {nativeToLittleEndian(zero && std::isnan(point.x) ? 0.0f : point.x),
+                          nativeToLittleEndian(zero && std::isnan(point.y) ? 0.0f : point.y),
+                          nativeToLittleEndian(zero && std::isnan(point.z) ? 0.0f : point.z)};
+    std::memcpy(out, xyz, sizeof(xyz));
+    out += sizeof(xyz);
   }
 
-  // Add the temporarily buffered data part to the ofstream
-  stream << strstream.rdbuf();
+  // skipped points leave unused space at the end
+  buffer.resize(static_cast<size_t>(out - buffer.data()));
+}
 
-  // Close file
-  stream.close();
+std::string PointCloudPlyWriter::plyHeader(size_t numberOfPoints, bool useBinary, bool hasColors, bool hasIntensities)
+{
+  std::ostringstream header;
+  header << "ply\n";
+  header << "format " << (useBinary ? "binary_little_endian" : "ascii") << " 1.0\n";
+  header << "element vertex " << numberOfPoints << "\n";
+  header << "property float x\n";
+  header << "property float y\n";
+  header << "property float z\n";
+  if (hasColors)
+  {
+    header << "property uchar red\n";
+    header << "property uchar green\n";
+    header << "property uchar blue\n";
+  }
+  if (hasIntensities)
+  {
+    header << "property float intensity\n";
+  }
+  header << "end_header\n";
 
-  return success;
+  return header.str();
+}
+
+bool PointCloudPlyWriter::writeFile(const char* filename, const std::vector<char>& buffer)
+{
+  std::ofstream stream(filename, std::ios_base::out | std::ios_base::binary);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+
+  stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+  return static_cast<bool>(stream);
 }
 
 PointCloudPlyWriter::PointCloudPlyWriter()
@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <string>
 
 #include "PointXYZ.h"
 
@@ -69,7 +70,22 @@ public:
   /// <returns>Returns true if write was successful and false otherwise</returns>
   static bool WriteFormatPLY(const char* filename, const std::vector<PointXYZ>& points, const std::vector<uint32_t>& rgbaMap, const std::vector<uint16_t>& intensityMap, bool useBinary, InvalidPointPresentation presentation = INVALID_AS_NAN);
 
+  /// <summary>Save a point cloud as raw packed little endian float x, y, z triples without a header.
+  /// Much smaller and faster to write than PLY, the number of points is the file size / 12.</summary>
+  /// <param name="filename">The file to save the point cloud to</param>
+  /// <param name="points">The points to save</param>
+  /// <param name="presentation">Definition how invalid points should be presented inside the file [optional]</param>
+  /// <returns>Returns true if write was successful and false otherwise</returns>
+  static bool WriteFormatRaw(const char* filename, const std::vector<PointXYZ>& points, InvalidPointPresentation presentation = INVALID_AS_NAN);
+
+  /// <summary>Append the points in the raw packed format of WriteFormatRaw to a buffer.</summary>
+  static void appendRawPoints(const std::vector<PointXYZ>& points, InvalidPointPresentation presentation, std::vector<char>& buffer);
+
 private:
+  // Assembles the whole binary file in memory and writes it with a single call
+  static bool writeBinaryPLY(const char* filename, const std::vector<PointXYZ>& points, const std::vector<uint32_t>& rgbaMap, const std::vector<uint16_t>& intensityMap, InvalidPointPresentation presentation);
+  static std::string plyHeader(size_t numberOfPoints, bool useBinary, bool hasColors, bool hasIntensities);
+  static bool writeFile(const char* filename, const std::vector<char>& buffer);
 
   // No instantiations
   PointCloudPlyWriter();
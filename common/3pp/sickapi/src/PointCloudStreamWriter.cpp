@@ -0,0 +1,178 @@
+//
+// SPDX-License-Identifier: Unlicense
+//
+
+#include "PointCloudStreamWriter.h"
+
+#include <cstring>
+
+#include "PointCloudPlyWriter.h"
+#include "VisionaryEndian.h"
+
+#ifdef SICKAPI_USE_SPDLOG
+#include <spdlog/spdlog.h>
+#else
+#include <iostream>
+#endif
+
+namespace visionary
+{
+
+namespace
+{
+constexpr size_t kFrameHeaderSize = 24u;
+constexpr std::chrono::seconds kOpenRetryDelay{1};
+
+template <typename T>
+void putLittleEndian(char* out, T value)
+{
+  value = nativeToLittleEndian(value);
+  std::memcpy(out, &value, sizeof(T));
+}
+}
+
+PointCloudStreamWriter::PointCloudStreamWriter(const std::string& basePath, uint64_t maxFileBytes, uint32_t maxFiles, size_t maxQueuedFrames)
+  : m_basePath(basePath)
+  , m_maxFileBytes(maxFileBytes)
+  , m_maxFiles(maxFiles > 0u ? maxFiles : 1u)
+  , m_maxQueuedFrames(maxQueuedFrames > 0u ? maxQueuedFrames : 1u)
+  , m_file(nullptr)
+  , m_fileIndex(0u)
+  , m_nextFileIndex(0u)
+  , m_fileBytes(0u)
+  , m_droppedFrames(0u)
+  , m_stop(false)
+{
+  m_writerThread = std::thread(&PointCloudStreamWriter::run, this);
+}
+
+PointCloudStreamWriter::~PointCloudStreamWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_frameQueued.notify_one();
+  m_writerThread.join();
+
+  if (m_file != nullptr)
+  {
+    std::fclose(m_file);
+  }
+}
+
+bool PointCloudStreamWriter::appendFrame(const std::vector<PointXYZ>& points, uint32_t width, uint32_t frameNumber, uint64_t timestampMs)
+{
+  QueuedFrame frame{points, width, frameNumber, timestampMs};
+
+  bool dropped = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queue.size() >= m_maxQueuedFrames)
+    {
+      m_queue.pop_front();
+      ++m_droppedFrames;
+      dropped = true;
+    }
+    m_queue.push_back(std::move(frame));
+  }
+  m_frameQueued.notify_one();
+
+  return !dropped;
+}
+
+uint64_t PointCloudStreamWriter::getDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_droppedFrames;
+}
+
+void PointCloudStreamWriter::run()
+{
+  while (true)
+  {
+    QueuedFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_frameQueued.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty())
+      {
+        return;
+      }
+      frame = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    if (!writeFrame(frame))
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_droppedFrames;
+    }
+  }
+}
+
+bool PointCloudStreamWriter::writeFrame(const QueuedFrame& frame)
+{
+  if (m_file == nullptr && std::chrono::steady_clock::now() < m_retryOpenAt)
+  {
+    return false;
+  }
+  if ((m_file == nullptr || m_fileBytes >= m_maxFileBytes) && !openNextFile())
+  {
+    return false;
+  }
+
+  // header and points in one buffer, written with a single call
+  m_buffer.resize(kFrameHeaderSize);
+  std::memcpy(m_buffer.data(), "PCSF", 4u);
+  putLittleEndian(m_buffer.data() + 4, frame.frameNumber);
+  putLittleEndian(m_buffer.data() + 8, frame.timestampMs);
+  putLittleEndian(m_buffer.data() + 16, frame.width);
+  putLittleEndian(m_buffer.data() + 20, static_cast<uint32_t>(frame.points.size()));
+  PointCloudPlyWriter::appendRawPoints(frame.points, INVALID_AS_NAN, m_buffer);
+
+  if (std::fwrite(m_buffer.data(), 1u, m_buffer.size(), m_file) != m_buffer.size())
+  {
+#ifdef SICKAPI_USE_SPDLOG
+    spdlog::get("sickapi")->error("Failed to write point cloud frame {} to {}.{}.pcs", frame.frameNumber, m_basePath, m_fileIndex);
+#else
+    std::cerr << "Failed to write point cloud frame " << frame.frameNumber << " to " << m_basePath << "." << m_fileIndex << ".pcs\n";
+#endif
+    // continue in the next file, a full disk may have room once an old file is overwritten
+    m_fileBytes = m_maxFileBytes;
+    return false;
+  }
+  m_fileBytes += m_buffer.size();
+
+  return true;
+}
+
+bool PointCloudStreamWriter::openNextFile()
+{
+  if (m_file != nullptr)
+  {
+    std::fclose(m_file);
+  }
+
+  // advance even if the open fails, so a file that cannot be written is skipped instead of retried forever
+  m_fileIndex = m_nextFileIndex;
+  m_nextFileIndex = (m_nextFileIndex + 1u) % m_maxFiles;
+
+  const std::string filename = m_basePath + "." + std::to_string(m_fileIndex) + ".pcs";
+  m_file = std::fopen(filename.c_str(), "wb");
+  m_fileBytes = 0u;
+  if (m_file == nullptr)
+  {
+#ifdef SICKAPI_USE_SPDLOG
+    spdlog::get("sickapi")->error("Failed to open point cloud stream file {}", filename);
+#else
+    std::cerr << "Failed to open point cloud stream file " << filename << "\n";
+#endif
+    m_retryOpenAt = std::chrono::steady_clock::now() + kOpenRetryDelay;
+    return false;
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,90 @@
+//
+// SPDX-License-Identifier: Unlicense
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PointXYZ.h"
+
+namespace visionary
+{
+
+/// <summary>Appends point cloud frames to a set of rolling files on a background thread.</summary>
+/// Frames are written to "basePath.0.pcs", "basePath.1.pcs", ... Once a file exceeds the size limit the next
+/// one is started, and after the last one the first is overwritten, so disk usage stays bounded. A file that
+/// cannot be opened is skipped, and frames are dropped for a second before the next file is tried.
+///
+/// Every frame is a 24 byte little endian header followed by its points in the raw packed format of
+/// PointCloudPlyWriter::WriteFormatRaw (invalid points as NaN):
+///   char     magic[4]        "PCSF"
+///   uint32_t frameNumber
+///   uint64_t timestampMs
+///   uint32_t width           points per image row, 0 if unknown
+///   uint32_t numberOfPoints
+class PointCloudStreamWriter
+{
+public:
+  /// <param name="basePath">Path of the files without the ".N.pcs" suffix</param>
+  /// <param name="maxFileBytes">Size after which the next file is started</param>
+  /// <param name="maxFiles">Number of files rotated through</param>
+  /// <param name="maxQueuedFrames">Frames waiting to be written before the oldest is dropped</param>
+  PointCloudStreamWriter(const std::string& basePath, uint64_t maxFileBytes, uint32_t maxFiles, size_t maxQueuedFrames = 4u);
+  /// Writes the frames still queued and closes the file
+  ~PointCloudStreamWriter();
+
+  PointCloudStreamWriter(const PointCloudStreamWriter&) = delete;
+  PointCloudStreamWriter& operator=(const PointCloudStreamWriter&) = delete;
+
+  /// <summary>Queue a frame for writing. Only copies the points, never waits for the disk.</summary>
+  /// <returns>Returns false if the queue was full and the oldest queued frame was dropped</returns>
+  bool appendFrame(const std::vector<PointXYZ>& points, uint32_t width, uint32_t frameNumber, uint64_t timestampMs);
+
+  /// <summary>Number of frames dropped because the disk could not keep up or a write failed.</summary>
+  uint64_t getDroppedFrames() const;
+
+private:
+  struct QueuedFrame
+  {
+    std::vector<PointXYZ> points;
+    uint32_t width;
+    uint32_t frameNumber;
+    uint64_t timestampMs;
+  };
+
+  void run();
+  bool writeFrame(const QueuedFrame& frame);
+  bool openNextFile();
+
+  const std::string m_basePath;
+  const uint64_t m_maxFileBytes;
+  const uint32_t m_maxFiles;
+  const size_t m_maxQueuedFrames;
+
+  // owned by the writer thread
+  std::FILE* m_file;
+  uint32_t m_fileIndex;
+  uint32_t m_nextFileIndex;
+  std::chrono::steady_clock::time_point m_retryOpenAt;
+  uint64_t m_fileBytes;
+  std::vector<char> m_buffer;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_frameQueued;
+  std::deque<QueuedFrame> m_queue;
+  uint64_t m_droppedFrames;
+  bool m_stop;
+
+  std::thread m_writerThread;
+};
+
+}
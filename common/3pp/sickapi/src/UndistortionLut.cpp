@@ -0,0 +1,197 @@
+//
+// SPDX-License-Identifier: Unlicense
+//
+
+#include "UndistortionLut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <list>
+#include <mutex>
+
+#include "VisionaryData.h"
+
+namespace visionary
+{
+
+namespace
+{
+// Tables kept alive after their last user is gone, enough for a few cameras and both image types
+constexpr size_t kMaxCachedLuts = 4u;
+
+struct CacheEntry
+{
+  CameraParameters params;
+  std::shared_ptr<const UndistortionLut> lut;
+};
+
+std::mutex cacheMutex;
+// most recently used first
+std::list<CacheEntry> cache;
+
+struct WorldCacheEntry
+{
+  CameraParameters params;
+  std::shared_ptr<const WorldLut> lut;
+};
+
+std::mutex worldCacheMutex;
+// most recently used first
+std::list<WorldCacheEntry> worldCache;
+
+// Only the parameters the lens model uses
+bool sameIntrinsics(const CameraParameters& a, const CameraParameters& b)
+{
+  return a.width == b.width && a.height == b.height && a.fx == b.fx && a.fy == b.fy && a.cx == b.cx && a.cy == b.cy
+         && a.k1 == b.k1 && a.k2 == b.k2;
+}
+
+// The intrinsics and everything the world transformation uses
+bool sameWorld(const CameraParameters& a, const CameraParameters& b)
+{
+  return sameIntrinsics(a, b) && a.f2rc == b.f2rc
+         && std::equal(std::begin(a.cam2worldMatrix), std::end(a.cam2worldMatrix), std::begin(b.cam2worldMatrix));
+}
+
+// One image row of the table. Float math without branches so the compiler vectorizes the loop, the type
+// dependent normalization is a template parameter instead of a per pixel check.
+template <bool Radial>
+void computeRow(const CameraParameters& params, int row, float* lutX, float* lutY, float* lutZ)
+{
+  // we map from image coordinates with origin top left and x horizontal (right) and y vertical (downwards)
+  // to camera coordinates with origin in center and x to the left and y upwards (seen from the sensor position)
+  const auto yp = static_cast<float>((params.cy - row) / params.fy);
+  const float yp2 = yp * yp;
+  const auto cx = static_cast<float>(params.cx);
+  const auto fx = static_cast<float>(params.fx);
+  const auto k1 = static_cast<float>(params.k1);
+  const auto k2 = static_cast<float>(params.k2);
+
+  for (int col = 0; col < params.width; col++)
+  {
+    const float xp = (cx - static_cast<float>(col)) / fx;
+
+    // correct the camera distortion
+    const float r2 = xp * xp + yp2;
+    const float k = 1.0f + k1 * r2 + k2 * r2 * r2;
+
+    // Undistorted direction vector of the point
+    const float x = xp * k;
+    const float y = yp * k;
+    const float s0 = Radial ? std::sqrt(x * x + y * y + 1.0f) * 1000.0f : 1000.0f;
+    lutX[col] = x / s0;
+    lutY[col] = y / s0;
+    lutZ[col] = 1.0f / s0;
+  }
+}
+
+std::shared_ptr<const UndistortionLut> computeLut(const CameraParameters& params, bool radial)
+{
+  auto lut = std::make_shared<UndistortionLut>();
+  lut->width = params.width;
+  lut->height = params.height;
+  lut->radial = radial;
+
+  const size_t numPixels = static_cast<size_t>(params.width) * static_cast<size_t>(params.height);
+  lut->x.resize(numPixels);
+  lut->y.resize(numPixels);
+  lut->z.resize(numPixels);
+
+  for (int row = 0; row < params.height; row++)
+  {
+    const size_t first = static_cast<size_t>(row) * static_cast<size_t>(params.width);
+    if (radial)
+    {
+      computeRow<true>(params, row, lut->x.data() + first, lut->y.data() + first, lut->z.data() + first);
+    }
+    else
+    {
+      computeRow<false>(params, row, lut->x.data() + first, lut->y.data() + first, lut->z.data() + first);
+    }
+  }
+
+  return lut;
+}
+
+std::shared_ptr<const WorldLut> computeWorldLut(const CameraParameters& params, bool radial)
+{
+  const std::shared_ptr<const UndistortionLut> camera = getUndistortionLut(params, radial);
+
+  auto lut = std::make_shared<WorldLut>();
+  lut->width = params.width;
+  lut->height = params.height;
+  lut->radial = radial;
+
+  // rotate the camera look-up-table, the translation is added per pixel as a constant offset
+  const double* m = params.cam2worldMatrix;
+  const size_t numPixels = camera->x.size();
+  lut->x.resize(numPixels);
+  lut->y.resize(numPixels);
+  lut->z.resize(numPixels);
+  for (size_t i = 0u; i < numPixels; ++i)
+  {
+    const double x = camera->x[i];
+    const double y = camera->y[i];
+    const double z = camera->z[i];
+    lut->x[i] = static_cast<float>(x * m[0] + y * m[1] + z * m[2]);
+    lut->y[i] = static_cast<float>(x * m[4] + y * m[5] + z * m[6]);
+    lut->z[i] = static_cast<float>(x * m[8] + y * m[9] + z * m[10]);
+  }
+
+  // world = R * (lut * distance - f2rc * ez) + t = (R * lut) * distance + (t - f2rc * R * ez)
+  const double f2rc = params.f2rc / 1000.;
+  lut->offset = PointXYZ{static_cast<float>(m[3] / 1000. - f2rc * m[2]),
+                         static_cast<float>(m[7] / 1000. - f2rc * m[6]),
+                         static_cast<float>(m[11] / 1000. - f2rc * m[10])};
+
+  return lut;
+}
+}
+
+std::shared_ptr<const UndistortionLut> getUndistortionLut(const CameraParameters& params, bool radial)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  for (auto it = cache.begin(); it != cache.end(); ++it)
+  {
+    if (it->lut->radial == radial && sameIntrinsics(it->params, params))
+    {
+      cache.splice(cache.begin(), cache, it);
+      return cache.front().lut;
+    }
+  }
+
+  // computed under the lock, so handlers asking for the same camera at once wait for a single computation
+  cache.push_front(CacheEntry{params, computeLut(params, radial)});
+  if (cache.size() > kMaxCachedLuts)
+  {
+    cache.pop_back();
+  }
+
+  return cache.front().lut;
+}
+
+std::shared_ptr<const WorldLut> getWorldLut(const CameraParameters& params, bool radial)
+{
+  std::lock_guard<std::mutex> lock(worldCacheMutex);
+
+  for (auto it = worldCache.begin(); it != worldCache.end(); ++it)
+  {
+    if (it->lut->radial == radial && sameWorld(it->params, params))
+    {
+      worldCache.splice(worldCache.begin(), worldCache, it);
+      return worldCache.front().lut;
+    }
+  }
+
+  worldCache.push_front(WorldCacheEntry{params, computeWorldLut(params, radial)});
+  if (worldCache.size() > kMaxCachedLuts)
+  {
+    worldCache.pop_back();
+  }
+
+  return worldCache.front().lut;
+}
+
+}
@@ -0,0 +1,113 @@
+//
+// SPDX-License-Identifier: Unlicense
+//
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "PointXYZ.h"
+
+namespace visionary
+{
+
+struct CameraParameters;
+
+/// <summary>Allocator returning memory aligned to Alignment bytes, so SIMD loads never split a cache line.</summary>
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+  using value_type = T;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return false;
+  }
+};
+
+using AlignedFloatVector = std::vector<float, AlignedAllocator<float, 64u>>;
+
+/// <summary>Undistorted direction of every pixel in [m/mm], one table per component (structure of arrays).</summary>
+/// Multiplying an entry with the distance of its pixel in [mm] gives the point in [m]. For radial images the
+/// directions are normalized, for planar images z is 1/1000.
+struct UndistortionLut
+{
+  int width;
+  int height;
+  bool radial;
+  AlignedFloatVector x;
+  AlignedFloatVector y;
+  AlignedFloatVector z;
+};
+
+/// <summary>Returns the look-up-table for the given camera, computed on first use.</summary>
+/// Tables are shared between all callers with the same intrinsics and distortion parameters, and the most
+/// recently used ones are kept after their last user is gone, so reconnecting to a camera or a second data
+/// handler for the same camera does not compute them again. Thread safe.
+std::shared_ptr<const UndistortionLut> getUndistortionLut(const CameraParameters& params, bool radial);
+
+/// <summary>Undistorted direction of every pixel rotated into world space by the Cam2World matrix.</summary>
+/// A pixel measuring d [mm] sees the world point (x, y, z) * d + offset in [m]. The offset is the Cam2World
+/// translation with the FocalToRayCross correction folded in.
+struct WorldLut
+{
+  int width;
+  int height;
+  bool radial;
+  AlignedFloatVector x;
+  AlignedFloatVector y;
+  AlignedFloatVector z;
+  PointXYZ offset;
+};
+
+/// <summary>Returns the world space look-up-table for the given camera, computed on first use.</summary>
+/// Shared and cached like getUndistortionLut, for cameras with the same intrinsics, Cam2World matrix and
+/// FocalToRayCross. Thread safe.
+std::shared_ptr<const WorldLut> getWorldLut(const CameraParameters& params, bool radial);
+
+/// <summary>Distance of a pixel in [mm], NaN for invalid pixels (0 and 0xFFFF).</summary>
+/// The NaN is selected by masking the bits instead of branching and propagates into all three coordinates of
+/// a point computed from it.
+inline float maskedDistance(uint16_t value, float pixelSizeZ)
+{
+  constexpr uint32_t badPointBits = std::bit_cast<uint32_t>(std::numeric_limits<float>::quiet_NaN());
+  const uint32_t validMask = 0u - static_cast<uint32_t>(static_cast<uint32_t>(value) - 1u < 0xFFFEu);
+  const uint32_t distance = std::bit_cast<uint32_t>(static_cast<float>(value) * pixelSizeZ);
+  return std::bit_cast<float>((distance & validMask) | (badPointBits & ~validMask));
+}
+
+}
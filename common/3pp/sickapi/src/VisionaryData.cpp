@@ -16,6 +16,7 @@
 #include <chrono>
 #include <ctime>
 #include <iostream>
+#include <thread>
 
 #ifdef SICKAPI_USE_SPDLOG
 #include <spdlog/spdlog.h>
@@ -26,12 +27,56 @@ namespace visionary
 
 const float bad_point = std::numeric_limits<float>::quiet_NaN();
 
+namespace
+{
+// Pixels converted per block. Each block is computed into small SoA arrays with a branch-free select for
+// invalid pixels, which the compiler turns into 8/16-wide SIMD, and then interleaved into the output.
+constexpr size_t kBlockSize = 16u;
+
+// Images smaller than this many points per thread are not split
+constexpr size_t kMinPointsPerThread = 32768u;
+
+// Converts 'count' pixels to lut * distance + offset
+void convertPoints(const uint16_t* map, const float* lutX, const float* lutY, const float* lutZ,
+                   float pixelSizeZ, const PointXYZ& offset, PointXYZ* pointCloud, size_t count)
+{
+  float xs[kBlockSize];
+  float ys[kBlockSize];
+  float zs[kBlockSize];
+
+  size_t i = 0u;
+  for (; i + kBlockSize <= count; i += kBlockSize)
+  {
+    for (size_t j = 0u; j < kBlockSize; ++j)
+    {
+      const float distance = maskedDistance(map[i + j], pixelSizeZ);
+      xs[j] = lutX[i + j] * distance + offset.x;
+      ys[j] = lutY[i + j] * distance + offset.y;
+      zs[j] = lutZ[i + j] * distance + offset.z;
+    }
+    for (size_t j = 0u; j < kBlockSize; ++j)
+    {
+      pointCloud[i + j] = PointXYZ{xs[j], ys[j], zs[j]};
+    }
+  }
+
+  // remaining pixels of the last incomplete block
+  for (; i < count; ++i)
+  {
+    const float distance = maskedDistance(map[i], pixelSizeZ);
+    pointCloud[i] = PointXYZ{lutX[i] * distance + offset.x, lutY[i] * distance + offset.y, lutZ[i] * distance + offset.z};
+  }
+}
+}
+
 VisionaryData::VisionaryData()
 	: m_scaleZ(0.0f)
     , m_changeCounter(0u)
     , m_frameNum(0u)
     , m_blobTimestamp(0u)
     , m_preCalcCamInfoType(VisionaryData::UNKNOWN)
+    , m_preCalcWorldInfoType(VisionaryData::UNKNOWN)
+    , m_pointCloudThreads(1u)
 {
   m_cameraParams.width = 0;
   m_cameraParams.height = 0;
@@ -78,62 +123,32 @@ void VisionaryData::preCalcCamInfo(const ImageType& imgType)
   assert(m_cameraParams.height > 0);
   assert(m_cameraParams.width > 0);
 
-  
-  m_preCalcCamInfo.reserve(static_cast<size_t>(m_cameraParams.height * m_cameraParams.width));
-
-  //-----------------------------------------------
-  // transform each pixel into Cartesian coordinates
-  for (int row = 0; row < m_cameraParams.height; row++)
+  if (RADIAL != imgType && PLANAR != imgType)
   {
-    double yp = (m_cameraParams.cy - row) / m_cameraParams.fy;
-    double yp2 = yp * yp;
-
-    for (int col = 0; col < m_cameraParams.width; col++)
-    {
-        // we map from image coordinates with origin top left and x
-        // horizontal (right) and y vertical
-        // (downwards) to camera coordinates with origin in center and x
-        // to the left and y upwards (seen
-        // from the sensor position)
-        const double xp = (m_cameraParams.cx - col) / m_cameraParams.fx;
-
-        // correct the camera distortion
-        const double r2 = xp * xp + yp2;
-        const double r4 = r2 * r2;
-        const double k = 1 + m_cameraParams.k1 * r2 + m_cameraParams.k2 * r4;
-        
-        // Undistorted direction vector of the point
-        const auto x = static_cast<float>(xp * k);
-        const auto y = static_cast<float>(yp * k);
-        const float z = 1.0f;
-        double s0 = 0;
-        if (RADIAL == imgType)
-        {
-          s0 = std::sqrt(x * x + y * y + z * z) * 1000;
-        }
-        else if (PLANAR == imgType)
-        {
-          s0 = 1000;
-        }
-        else
-        {
 #ifdef SICKAPI_USE_SPDLOG
-          spdlog::get("sickapi")->error("Unknown image type for the point cloud transformation");
+    spdlog::get("sickapi")->error("Unknown image type for the point cloud transformation");
 #else
-          std::cerr << "Unknown image type for the point cloud transformation\n";
+    std::cerr << "Unknown image type for the point cloud transformation\n";
 #endif
 
-          assert(false);
-        }
-        PointXYZ point{};
-        point.x = static_cast<float>(x / s0);
-        point.y = static_cast<float>(y / s0);
-        point.z = static_cast<float>(z / s0);
-
-        m_preCalcCamInfo.push_back(point);
-    }
+    assert(false);
   }
+
+  m_preCalcCamInfo = getUndistortionLut(m_cameraParams, RADIAL == imgType);
   m_preCalcCamInfoType = imgType;
+  // the world look-up-tables are derived from these
+  m_preCalcWorldInfoType = UNKNOWN;
+}
+
+void VisionaryData::preCalcWorldInfo(const ImageType& imgType)
+{
+  if (m_preCalcCamInfoType != imgType)
+  {
+    preCalcCamInfo(imgType);
+  }
+
+  m_preCalcWorldInfo = getWorldLut(m_cameraParams, RADIAL == imgType);
+  m_preCalcWorldInfoType = imgType;
 }
 
 void VisionaryData::generatePointCloud(const std::vector<uint16_t>& map, const ImageType& imgType, std::vector<PointXYZ> &pointCloud)
@@ -143,40 +158,59 @@ void VisionaryData::generatePointCloud(const std::vector<uint16_t>& map, const I
   {
     preCalcCamInfo(imgType);
   }
-  size_t cloudSize = map.size();
-  pointCloud.resize(cloudSize);
 
   const auto f2rc = static_cast<float>(m_cameraParams.f2rc / 1000.f); // PointCloud should be in [m] and not in [mm]
 
+  convertPointCloud(map, m_preCalcCamInfo->x, m_preCalcCamInfo->y, m_preCalcCamInfo->z, PointXYZ{0.f, 0.f, -f2rc}, pointCloud);
+}
+
+void VisionaryData::generateWorldPointCloud(const std::vector<uint16_t>& map, const ImageType& imgType, std::vector<PointXYZ> &pointCloud)
+{
+  // Calculate the rotated look-up-tables from XML metadata once.
+  if (m_preCalcWorldInfoType != imgType || m_preCalcCamInfoType != imgType)
+  {
+    preCalcWorldInfo(imgType);
+  }
+
+  convertPointCloud(map, m_preCalcWorldInfo->x, m_preCalcWorldInfo->y, m_preCalcWorldInfo->z, m_preCalcWorldInfo->offset, pointCloud);
+}
+
+void VisionaryData::convertPointCloud(const std::vector<uint16_t>& map, const AlignedFloatVector& lutX,
+                                      const AlignedFloatVector& lutY, const AlignedFloatVector& lutZ,
+                                      const PointXYZ& offset, std::vector<PointXYZ>& pointCloud) const
+{
+  const size_t cloudSize = std::min(map.size(), lutX.size());
+  pointCloud.resize(cloudSize);
+
   const float pixelSizeZ = m_scaleZ;
 
   //-----------------------------------------------
-  // transform each pixel into Cartesian coordinates
-  auto itMap = map.begin();
-  auto itUndistorted = m_preCalcCamInfo.begin();
-  auto itPC = pointCloud.begin();
-  for (uint32_t i = 0; i < cloudSize; ++i, ++itPC, ++itMap, ++itUndistorted)
-  //for (std::vector<PointXYZ>::iterator itPC = pointCloud.begin(), itEnd = pointCloud.end(); itPC != itEnd; ++itPC, ++itMap, ++itUndistorted)
+  // transform each pixel into Cartesian coordinates, split into block aligned ranges for large images
+  const size_t numThreads = std::max<size_t>(1u, std::min<size_t>(m_pointCloudThreads, cloudSize / kMinPointsPerThread));
+  const size_t rangeSize = ((cloudSize / numThreads + kBlockSize - 1u) / kBlockSize) * kBlockSize;
+
+  const auto convertRange = [&](size_t begin)
   {
-    PointXYZ point{};
-    // If point is valid put it to point cloud
-    if (*itMap == 0 || *itMap == uint16_t(0xFFFF))
-    {
-      point.x = bad_point;
-      point.y = bad_point;
-      point.z = bad_point;
-    }
-    else
-    {
-      // calculate coordinates & store in point cloud vector
-      float distance = static_cast<float>((*itMap)) * pixelSizeZ;
-      point.x = itUndistorted->x * distance;
-      point.y = itUndistorted->y * distance;
-      point.z = itUndistorted->z * distance - f2rc;
-    }
-    *itPC = point;
+    const size_t count = std::min(rangeSize, cloudSize - begin);
+    convertPoints(map.data() + begin, lutX.data() + begin, lutY.data() + begin, lutZ.data() + begin, pixelSizeZ,
+                  offset, pointCloud.data() + begin, count);
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t begin = rangeSize; begin < cloudSize; begin += rangeSize)
+  {
+    workers.emplace_back(convertRange, begin);
+  }
+  convertRange(0u);
+  for (auto& worker : workers)
+  {
+    worker.join();
   }
-  return;
+}
+
+void VisionaryData::setPointCloudThreads(unsigned int threads)
+{
+  m_pointCloudThreads = std::max(1u, threads);
 }
 
 void VisionaryData::transformPointCloud(std::vector<PointXYZ> &pointCloud) const
@@ -240,4 +274,9 @@ const CameraParameters& VisionaryData::getCameraParameters() const
   return m_cameraParams;
 }
 
+float VisionaryData::getDistanceUnit() const
+{
+  return m_scaleZ;
+}
+
 }
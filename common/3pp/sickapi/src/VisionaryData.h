@@ -9,10 +9,12 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "PointXYZ.h"
+#include "UndistortionLut.h"
 
 namespace visionary 
 {
@@ -62,6 +64,14 @@ public:
   // IN/OUT pointCloud  - Reference to the point cloud to be transformed. Contains the transformed point cloud afterwards.
   void transformPointCloud(std::vector<PointXYZ> &pointCloud) const;
 
+  // Calculate and return the Point Cloud already transformed with the Cam2World matrix. Units are in meters.
+  // Same result as generatePointCloud followed by transformPointCloud in a single pass over the image.
+  virtual void generateWorldPointCloud(std::vector<PointXYZ> &pointCloud) = 0;
+
+  // Number of threads generatePointCloud splits large images across.
+  // 1 (default) converts on the calling thread.
+  void setPointCloudThreads(unsigned int threads);
+
   int getHeight() const;
   int getWidth() const;
   // Returns the Byte length compared to data types
@@ -74,6 +84,8 @@ public:
   uint64_t getTimestampMS() const;
   // Returns a reference to the camera parameter struct
   const CameraParameters& getCameraParameters() const;
+  // Returns the size of one distance map unit in [mm], 0 before the first blob was parsed
+  float getDistanceUnit() const;
 
   //-----------------------------------------------
   // functions for parsing received blob
@@ -93,8 +105,8 @@ protected:
   // Returns the Byte length compared to data type given as String
   int getItemLength(std::string dataType);
 
-  // Pre-calculate lookup table for lens distortion correction, 
-  // which is needed for point cloud calculation.
+  // Look up the table for lens distortion correction, which is needed for point cloud calculation.
+  // The table is shared with all other data handlers of a camera with the same parameters.
   void preCalcCamInfo(const ImageType& type);
 
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
@@ -103,6 +115,15 @@ protected:
   // OUT pointCloud  - Reference to pass back the point cloud. Will be resized and only contain new point cloud.
   void generatePointCloud(const std::vector<uint16_t>& map, const ImageType& imgType, std::vector<PointXYZ> &pointCloud);
 
+  // Look up the lens look-up-table rotated by the Cam2World matrix.
+  void preCalcWorldInfo(const ImageType& type);
+
+  // Calculate and return the Point Cloud in world coordinates. Units are in meters.
+  // IN  map         - Image to be transformed
+  // IN  imgType     - Type of the image (needed for correct transformation)
+  // OUT pointCloud  - Reference to pass back the point cloud. Will be resized and only contain new point cloud.
+  void generateWorldPointCloud(const std::vector<uint16_t>& map, const ImageType& imgType, std::vector<PointXYZ> &pointCloud);
+
   //-----------------------------------------------
   // Camera parameters to be read from XML Metadata part
   CameraParameters m_cameraParams{};
@@ -125,10 +146,23 @@ protected:
 
   // Camera undistort pre-calculations (look-up-tables) are generated to speed up computations. True if this has been done.
   ImageType m_preCalcCamInfoType;
-  // The look-up-tables containing pre-calculations
-  std::vector<PointXYZ> m_preCalcCamInfo;
+  // The shared look-up-table containing pre-calculations
+  std::shared_ptr<const UndistortionLut> m_preCalcCamInfo;
+
+  // Look-up-table rotated by the Cam2World matrix for world space point clouds, valid for m_preCalcWorldInfoType.
+  // Shared like m_preCalcCamInfo
+  ImageType m_preCalcWorldInfoType;
+  std::shared_ptr<const WorldLut> m_preCalcWorldInfo;
+
+  // Threads used by generatePointCloud
+  unsigned int m_pointCloudThreads;
 
 private:
+  // Converts every pixel of map to lut * distance + offset
+  void convertPointCloud(const std::vector<uint16_t>& map, const AlignedFloatVector& lutX,
+                         const AlignedFloatVector& lutY, const AlignedFloatVector& lutZ,
+                         const PointXYZ& offset, std::vector<PointXYZ>& pointCloud) const;
+
   // Bitmasks to calculate the timestamp in milliseconds
   // Bits of the devices timestamp: 5 unused - 12 Year - 4 Month - 5 Day - 11 Timezone - 5 Hour - 6 Minute - 6 Seconds - 10 Milliseconds
   // .....YYYYYYYYYYYYMMMMDDDDDTTTTTTTTTTTHHHHHMMMMMMSSSSSSmmmmmmmmmm
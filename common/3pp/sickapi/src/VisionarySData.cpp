@@ -254,6 +254,11 @@ void VisionarySData::generatePointCloud(std::vector<PointXYZ> &pointCloud)
   return VisionaryData::generatePointCloud(m_zMap, VisionaryData::PLANAR, pointCloud);
 }
 
+void VisionarySData::generateWorldPointCloud(std::vector<PointXYZ> &pointCloud)
+{
+  return VisionaryData::generateWorldPointCloud(m_zMap, VisionaryData::PLANAR, pointCloud);
+}
+
 const std::vector<uint16_t>& VisionarySData::getZMap() const
 {
   return m_zMap;
@@ -29,6 +29,8 @@ public:
   const std::vector<uint16_t>& getConfidenceMap() const;
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
   void generatePointCloud(std::vector<PointXYZ> &pointCloud) override;
+  // Calculate and return the Point Cloud in world coordinates. Units are in meters.
+  void generateWorldPointCloud(std::vector<PointXYZ> &pointCloud) override;
 
 protected:
   //-----------------------------------------------
@@ -438,6 +438,11 @@ void VisionaryTData::generatePointCloud(std::vector<PointXYZ> &pointCloud)
   return VisionaryData::generatePointCloud(m_distanceMap, VisionaryData::RADIAL, pointCloud);
 }
 
+void VisionaryTData::generateWorldPointCloud(std::vector<PointXYZ> &pointCloud)
+{
+  return VisionaryData::generateWorldPointCloud(m_distanceMap, VisionaryData::RADIAL, pointCloud);
+}
+
 const std::vector<uint16_t>& VisionaryTData::getDistanceMap() const
 {
   return m_distanceMap;
@@ -48,6 +48,8 @@ public:
  
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
   void generatePointCloud(std::vector<PointXYZ> &pointCloud) override;
+  // Calculate and return the Point Cloud in world coordinates. Units are in meters.
+  void generateWorldPointCloud(std::vector<PointXYZ> &pointCloud) override;
 
 protected:
   //-----------------------------------------------
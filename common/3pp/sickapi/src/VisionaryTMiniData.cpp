@@ -295,6 +295,11 @@ void VisionaryTMiniData::generatePointCloud(std::vector<PointXYZ> &pointCloud)
   return VisionaryData::generatePointCloud(m_distanceMap, VisionaryData::RADIAL, pointCloud);
 }
 
+void VisionaryTMiniData::generateWorldPointCloud(std::vector<PointXYZ> &pointCloud)
+{
+  return VisionaryData::generateWorldPointCloud(m_distanceMap, VisionaryData::RADIAL, pointCloud);
+}
+
 const std::vector<uint16_t>& VisionaryTMiniData::getDistanceMap() const
 {
   return m_distanceMap;
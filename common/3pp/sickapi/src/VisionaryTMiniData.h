@@ -37,6 +37,8 @@ public:
 
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
   void generatePointCloud(std::vector<PointXYZ> &pointCloud) override;
+  // Calculate and return the Point Cloud in world coordinates. Units are in meters.
+  void generateWorldPointCloud(std::vector<PointXYZ> &pointCloud) override;
 
   // factor to convert Radial distance map from fixed point to floating point
   static const float DISTANCE_MAP_UNIT;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace processing
+{
+	/**
+	 * @brief Fixed capacity FIFO connecting two threads.
+	 *
+	 * Pushing never blocks: when the queue is full the oldest element is dropped, so a slow consumer
+	 * always works on recent data instead of building up latency. Popping blocks until an element is
+	 * available or the queue is closed.
+	 */
+	template<typename T>
+	class bounded_queue
+	{
+	public:
+		bounded_queue(const size_t capacity)
+			: _capacity(capacity), _closed(false)
+		{
+		}
+
+		/**
+		 * @brief Appends an element, dropping the oldest one if the queue is full.
+		 *
+		 * @return True if an element was dropped
+		 */
+		const bool push(T&& value)
+		{
+			bool dropped = false;
+			{
+				std::lock_guard<std::mutex> locker(_mutex);
+				if (_closed)
+					return false;
+
+				if (_queue.size() >= _capacity)
+				{
+					_queue.pop_front();
+					dropped = true;
+				}
+				_queue.push_back(std::move(value));
+			}
+			_cv.notify_one();
+
+			return dropped;
+		}
+
+		/**
+		 * @brief Waits for the next element.
+		 *
+		 * @return False if the queue was closed and no element is left
+		 */
+		const bool pop(T& value)
+		{
+			std::unique_lock<std::mutex> locker(_mutex);
+			_cv.wait(locker, [this]() { return !_queue.empty() || _closed; });
+			if (_queue.empty())
+				return false;
+
+			value = std::move(_queue.front());
+			_queue.pop_front();
+
+			return true;
+		}
+
+		/**
+		 * @brief Wakes all waiting consumers. Elements pushed after closing are discarded.
+		 */
+		void close()
+		{
+			{
+				std::lock_guard<std::mutex> locker(_mutex);
+				_closed = true;
+			}
+			_cv.notify_all();
+		}
+
+	private:
+		const size_t _capacity;
+		bool _closed;
+
+		std::mutex _mutex;
+		std::condition_variable _cv;
+		std::deque<T> _queue;
+	};
+}
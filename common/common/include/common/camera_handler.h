@@ -4,25 +4,43 @@
 
 #include "common/frame.h"
 
-#include "Framegrabber.h"
 #include "VisionaryControl.h"
-#include "VisionaryTMiniData.h"
 
 namespace camera
 {
+	// camera family, each sends its own blob layout
+	enum class camera_type
+	{
+		visionary_t_mini,
+		// z map, colour image and confidence map
+		visionary_s,
+		// distance, intensity and confidence maps
+		visionary_t
+	};
+
+	const bool parse_camera_type(const std::string& name, camera_type& parsed);
+
+	// frame grabber and data handler of one camera type
+	class frame_source;
+
 	class camera_handler
 	{
 	public:
 		camera_handler();
 		~camera_handler();
 
-		const bool open(const std::string& ip, const uint16_t& port, const uint32_t& timeout_ms);
+		const bool open(const std::string& ip, const uint16_t& port, const uint32_t& timeout_ms, const camera_type type = camera_type::visionary_t_mini);
+		void set_scan_kind(const frame::kind kind);
 		const bool get_current_frame(frame::Frame& frame);
 		const bool get_next_frame(frame::Frame& frame, const uint64_t timeout_ms = 1000);
 
 	private:
-		std::unique_ptr<visionary::FrameGrabber<visionary::VisionaryTMiniData>> _frame_grabber;
-		std::shared_ptr<visionary::VisionaryTMiniData> _data_handler;
+		std::unique_ptr<frame_source> _source;
 		std::unique_ptr<visionary::VisionaryControl> _visionary_control;
+		std::shared_ptr<const cloud::camera_model> _camera;
+		frame::kind _scan_kind;
+		frame::buffer_pool _buffers;
+
+		void fill_frame(frame::Frame& frame);
 	};
 }
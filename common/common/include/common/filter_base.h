@@ -8,6 +8,9 @@
 #include "json.hpp"
 
 #include "common/filter_parameter.h"
+#include "common/frame.h"
+#include "common/point_cloud.h"
+#include "common/rate_limiter.h"
 
 namespace filter
 {
@@ -18,9 +21,54 @@ namespace filter
 
 		virtual std::unique_ptr<filter_base> clone() const = 0;
 		virtual const std::string type() const = 0;
-		virtual const bool apply(cv::Mat&) const = 0;
+		virtual const bool apply_to(const cv::Mat& input, cv::Mat& output) const = 0;
 		virtual const bool load_json(const nlohmann::json& filter) = 0;
 		virtual const nlohmann::json to_json() const = 0;
+
+		// size of the image 'apply_to' produces for an input of size 'input', false if the filter cannot handle that input
+		virtual const bool output_size(const cv::Size& input, cv::Size& output) const { output = input; return true; };
+
+		// called when this filter replaces 'previous' in a running pipeline so stateful filters can keep their history
+		virtual void adopt_state(const filter_base& previous) {};
+
+		// true if the last 'apply_to' found the frame unchanged, so the filters after it and sending the result can be skipped
+		virtual const bool frame_unchanged() const { return false; };
+
+		// true if the filter works on the world space points of its input, the pipeline then calls 'apply_to_cloud' instead of 'apply_to'
+		virtual const bool uses_point_cloud() const { return false; };
+
+		// 'points' holds the world space point of every pixel of 'input'. point cloud filters may only invalidate (zero) pixels, so
+		// consecutive ones can share the points
+		virtual const bool apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const { return apply_to(input, output); };
+
+		// true if the filter needs the parameters of the camera its input comes from, the pipeline then calls 'apply_with_camera'
+		// instead of 'apply_to' if it knows the camera
+		virtual const bool uses_camera() const { return false; };
+
+		// 'input' is at the resolution of 'camera'
+		virtual const bool apply_with_camera(const cv::Mat& input, const cloud::camera_model& camera, cv::Mat& output) const { return apply_to(input, output); };
+
+		// true if the filter also reads another channel of the camera frame (see 'frame::channel'), set in 'channel'. the
+		// pipeline then calls 'apply_with_channel' instead of 'apply_to'
+		virtual const bool uses_channel(frame::channel& channel) const { return false; };
+
+		// 'channel' is the channel named by 'uses_channel' of the frame 'input' came from, empty if the frame does not have it
+		virtual const bool apply_with_channel(const cv::Mat& input, const cv::Mat& channel, cv::Mat& output) const { return apply_to(input, output); };
+
+		// true if the filter works on polar scans and point lists (see 'frame::Scan') instead of images. the pipeline then calls
+		// 'apply_to_scan' and such a filter cannot be part of an image pipeline
+		virtual const bool uses_scan() const { return false; };
+
+		// filters a polar scan or point list, image filters fail
+		virtual const bool apply_to_scan(const frame::Scan& input, frame::Scan& output) const { log_apply_error("works on images only"); return false; };
+
+		const bool apply(cv::Mat& mat) const;
+
+	protected:
+		void log_apply_error(const char* what) const;
+
+	private:
+		mutable logging::rate_limiter _apply_error_limiter;
 	};
 }
 
@@ -5,28 +5,70 @@
 
 #include "common/filter_base.h"
 		  
+#include "common/filters/angular_median_filter.h"
+#include "common/filters/background_subtraction_filter.h"
 #include "common/filters/bilateral_filter.h"
 #include "common/filters/blur_filter.h"
+#include "common/filters/cell_statistic_filter.h"
+#include "common/filters/channel_gate_filter.h"
+#include "common/filters/change_detection_filter.h"
+#include "common/filters/connected_components_filter.h"
 #include "common/filters/crop_filter.h"
 #include "common/filters/gaussian_blur_filter.h"
+#include "common/filters/guided_filter.h"
 #include "common/filters/median_filter.h"
+#include "common/filters/morphology_filter.h"
 #include "common/filters/moving_average_filter.h"
+#include "common/filters/occupancy_grid_filter.h"
+#include "common/filters/range_gate_filter.h"
 #include "common/filters/resize_filter.h"
+#include "common/filters/sector_min_filter.h"
 #include "common/filters/stack_blur_filter.h"
+#include "common/filters/temporal_hole_fill_filter.h"
+#include "common/filters/temporal_median_filter.h"
 #include "common/filters/threshold_filter.h"
+#include "common/filters/voxel_filter.h"
+#include "common/filters/world_crop_filter.h"
 
 namespace filter
 {
 	const static std::unordered_map<std::string, std::function<std::unique_ptr<filter_base>()>> types = {
+		{ angular_median_filter().type(), []() { return angular_median_filter().clone(); }},
+		{ background_subtraction_filter(background_model::reference).type(), []() { return background_subtraction_filter(background_model::reference).clone(); }},
+		{ background_subtraction_filter(background_model::plane).type(),     []() { return background_subtraction_filter(background_model::plane).clone(); }},
 		{ bilateral_filter().type(),      []() { return bilateral_filter().clone(); }},
 		{ blur_filter().type(),           []() { return blur_filter().clone(); }},
+		{ cell_statistic_filter(cell_statistic::count).type(),      []() { return cell_statistic_filter(cell_statistic::count).clone(); }},
+		{ cell_statistic_filter(cell_statistic::max).type(),        []() { return cell_statistic_filter(cell_statistic::max).clone(); }},
+		{ cell_statistic_filter(cell_statistic::mean).type(),       []() { return cell_statistic_filter(cell_statistic::mean).clone(); }},
+		{ cell_statistic_filter(cell_statistic::min).type(),        []() { return cell_statistic_filter(cell_statistic::min).clone(); }},
+		{ cell_statistic_filter(cell_statistic::percentile).type(), []() { return cell_statistic_filter(cell_statistic::percentile).clone(); }},
+		{ change_detection_filter().type(), []() { return change_detection_filter().clone(); }},
+		{ channel_gate_filter(frame::channel::confidence).type(), []() { return channel_gate_filter(frame::channel::confidence).clone(); }},
+		{ connected_components_filter().type(), []() { return connected_components_filter().clone(); }},
 		{ crop_filter().type(),		      []() { return crop_filter().clone(); }},
 		{ gaussian_blur_filter().type(),  []() { return gaussian_blur_filter().clone(); }},
+		{ guided_filter().type(),         []() { return guided_filter().clone(); }},
+		{ world_crop_filter(world_crop_region::height).type(), []() { return world_crop_filter(world_crop_region::height).clone(); }},
+		{ channel_gate_filter(frame::channel::intensity).type(), []() { return channel_gate_filter(frame::channel::intensity).clone(); }},
+		{ guided_filter(frame::channel::intensity).type(), []() { return guided_filter(frame::channel::intensity).clone(); }},
 		{ median_filter().type(),         []() { return median_filter().clone(); }},
+		{ morphology_filter(morphology_operation::close).type(),  []() { return morphology_filter(morphology_operation::close).clone(); }},
+		{ morphology_filter(morphology_operation::dilate).type(), []() { return morphology_filter(morphology_operation::dilate).clone(); }},
+		{ morphology_filter(morphology_operation::erode).type(),  []() { return morphology_filter(morphology_operation::erode).clone(); }},
+		{ morphology_filter(morphology_operation::open).type(),   []() { return morphology_filter(morphology_operation::open).clone(); }},
 		{ moving_average_filter().type(), []() { return moving_average_filter().clone(); }},
+		{ occupancy_grid_filter().type(), []() { return occupancy_grid_filter().clone(); }},
+		{ range_gate_filter().type(),     []() { return range_gate_filter().clone(); }},
 		{ resize_filter().type(),         []() { return resize_filter().clone(); }},
+		{ sector_min_filter().type(),     []() { return sector_min_filter().clone(); }},
 		{ stack_blur_filter().type(),     []() { return stack_blur_filter().clone(); }},
-		{ threshold_filter().type(),      []() { return threshold_filter().clone(); }}
+		{ channel_gate_filter(frame::channel::state).type(), []() { return channel_gate_filter(frame::channel::state).clone(); }},
+		{ temporal_hole_fill_filter().type(), []() { return temporal_hole_fill_filter().clone(); }},
+		{ temporal_median_filter().type(), []() { return temporal_median_filter().clone(); }},
+		{ threshold_filter().type(),      []() { return threshold_filter().clone(); }},
+		{ voxel_filter().type(),          []() { return voxel_filter().clone(); }},
+		{ world_crop_filter(world_crop_region::box).type(), []() { return world_crop_filter(world_crop_region::box).clone(); }}
 	};
 
 	static std::unique_ptr<filter_base> create(const std::string& type)
@@ -16,11 +16,17 @@ namespace filter
 		~filter_pipeline() = default;
 
 		filter_pipeline& operator=(const filter_pipeline& other);
+		filter_pipeline& operator=(filter_pipeline&& other) noexcept;
 
 		const void load_json(const nlohmann::json& filters);
 		const nlohmann::json to_json() const;
 		const bool apply(cv::Mat& mat) const;
+		const bool apply_to_scan(const frame::Scan& input, frame::Scan& output) const;
 		const bool empty() const;
+		const size_t size() const;
+		const filter_base& at(const size_t index) const;
+		void push_back(std::unique_ptr<filter_base> filter);
+		void adopt_state(const filter_pipeline& previous);
 
 	private:
 		std::vector<std::unique_ptr<filter_base>> filters;
@@ -7,6 +7,8 @@
 #include "opencv2/core/mat.hpp"
 
 #include "common/filter_pipeline.h"
+#include "common/frame.h"
+#include "common/pipeline_plan.h"
 
 namespace filter
 {
@@ -16,7 +18,7 @@ namespace filter
 		filter_worker();
 		~filter_worker();
 
-		const bool try_put_new(const cv::Mat& mat);
+		const bool try_put_new(const frame::Frame& frame);
 		const bool try_latest_mat(cv::Mat& mat) const;
 
 		void set_pipeline(const filter_pipeline& pipeline);
@@ -29,9 +31,13 @@ namespace filter
 		cv::Mat _latest_mat;
 
 		std::atomic_bool _new_mat;
-		cv::Mat _buffer;
+		// shares its buffer with the caller's frame, the worker only reads it
+		frame::Frame _frame;
 
+		mutable std::mutex _pipeline_mutex;
 		filter_pipeline _pipeline;
+		bool _pipeline_changed;
+		pipeline_plan _plan;
 
 		std::thread _thread;
 
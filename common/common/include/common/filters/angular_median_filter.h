@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Median over the 2 * 'radius' + 1 neighbouring rays of a polar scan, skipping rays without a
+	 * measurement. Rays without a measurement stay empty, so single spikes are removed without filling gaps.
+	 */
+	class angular_median_filter : public filter_base
+	{
+	public:
+		angular_median_filter();
+		~angular_median_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_scan() const override;
+		const bool apply_to_scan(const frame::Scan& input, frame::Scan& output) const override;
+
+	private:
+		filter::filter_parameter<int, 1, 16> radius;
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	enum class background_model
+	{
+		// per pixel mean depth of the warm-up frames
+		reference,
+		// plane through the warm-up mean, e.g. the floor, fitted along the rays of the camera
+		plane
+	};
+
+	/**
+	 * @brief Outputs the height of every pixel above a learned background, in depth units.
+	 *
+	 * The background is learned from the first 'warm-up-frames' frames, during which the output is zero.
+	 * Pixels that are invalid in the input or below the background are zero. With 'model-file' set, the
+	 * learned background is stored there as a 16 bit PNG and loaded again instead of repeating the warm-up.
+	 */
+	class background_subtraction_filter : public filter_base
+	{
+	public:
+		background_subtraction_filter(const background_model model = background_model::reference);
+		~background_subtraction_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+		void adopt_state(const filter_base& previous) override;
+
+		const bool uses_camera() const override;
+		const bool apply_with_camera(const cv::Mat& input, const cloud::camera_model& camera, cv::Mat& output) const override;
+
+	private:
+		background_model model;
+		filter::filter_parameter<int, 1, 10000> warm_up_frames;
+		std::string model_file;
+
+		// per pixel sum and number of valid depths seen during the warm-up
+		mutable std::vector<uint32_t> sum;
+		mutable std::vector<uint16_t> count;
+		mutable cv::Size size;
+		mutable int learned_frames;
+		// replaced as a whole, never written in place, so copies of the filter may share it
+		mutable cv::Mat background;
+		mutable bool model_file_checked;
+
+		const bool subtract(const cv::Mat& input, const cloud::camera_model* camera, cv::Mat& output) const;
+		void reset() const;
+		void learn(const cv::Mat& input) const;
+		void finish_learning(const cloud::camera_model* camera) const;
+		const bool fit_plane(const cloud::camera_model& camera, cv::Mat& mean) const;
+		const bool load_model(const cv::Size& input_size) const;
+		void save_model() const;
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	enum class cell_statistic
+	{
+		min,
+		max,
+		mean,
+		percentile,
+		count
+	};
+
+	/**
+	 * @brief Reduces the image to a grid of cells holding one statistic of the valid (non-zero) pixels
+	 * of each cell.
+	 *
+	 * The output is one pixel per cell, so a grid of the configured frame size goes to the PLC unchanged.
+	 * Cells without valid pixels are zero. Every statistic is registered as its own filter type so the
+	 * node editor, which only edits numbers, can offer all of them.
+	 */
+	class cell_statistic_filter : public filter_base
+	{
+	public:
+		cell_statistic_filter(const cell_statistic statistic = cell_statistic::min);
+		~cell_statistic_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+		const bool output_size(const cv::Size& input, cv::Size& output) const override;
+
+	private:
+		cell_statistic statistic;
+		filter::filter_parameter<int, 1, std::numeric_limits<int>::max()> cells_x;
+		filter::filter_parameter<int, 1, std::numeric_limits<int>::max()> cells_y;
+		filter::filter_parameter<double, 0.0, 100.0> percentile;
+
+		mutable std::vector<int> cell_of_column;
+		mutable std::vector<uint16_t> min;
+		mutable std::vector<uint16_t> max;
+		mutable std::vector<uint64_t> sum;
+		mutable std::vector<uint32_t> count;
+		mutable std::vector<std::vector<uint16_t>> values;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Passes frames through unchanged and reports frames that hardly differ from the last reported
+	 * change, so the rest of the pipeline and the PLC write can be skipped.
+	 *
+	 * Compares a sparse grid of samples, every 'step'th pixel in both directions, by mean absolute
+	 * difference. After 'max-skip' skipped frames in a row the next frame is reported as changed anyway.
+	 * Place it first in the pipeline, it only saves the work of the filters after it.
+	 */
+	class change_detection_filter : public filter_base
+	{
+	public:
+		change_detection_filter();
+		~change_detection_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "change-detection-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+		void adopt_state(const filter_base& previous) override;
+		const bool frame_unchanged() const override;
+
+	private:
+		filter::filter_parameter<double, 0.0, 65535.0> threshold;
+		filter::filter_parameter<int, 1, 64> step;
+		filter::filter_parameter<int, 0, 10000> max_skip;
+
+		// samples of the last frame reported as changed
+		mutable std::vector<uint16_t> reference;
+		mutable cv::Size size;
+		mutable int skipped;
+		mutable bool unchanged;
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Zeros the depth pixels whose value in another channel of the camera frame lies outside
+	 * ['lower', 'upper'], e.g. dark pixels with an unreliable distance or pixels the camera flagged in its
+	 * state or confidence map.
+	 *
+	 * The intensity, state and confidence variants are registered as their own filter type so the node editor, which
+	 * only edits numbers, can offer both.
+	 */
+	class channel_gate_filter : public filter_base
+	{
+	public:
+		channel_gate_filter(const frame::channel channel = frame::channel::intensity);
+		~channel_gate_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_channel(frame::channel& channel) const override;
+		const bool apply_with_channel(const cv::Mat& input, const cv::Mat& channel, cv::Mat& output) const override;
+
+	private:
+		frame::channel channel;
+		filter::filter_parameter<int, 0, 65535> upper;
+		filter::filter_parameter<int, 0, 65535> lower;
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	class connected_components_filter : public filter_base
+	{
+	public:
+		connected_components_filter();
+		~connected_components_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "connected-components-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+	private:
+		filter::filter_parameter<int, 1, std::numeric_limits<int>::max()> min_area;
+	};
+}
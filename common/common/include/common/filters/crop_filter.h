@@ -13,11 +13,14 @@ namespace filter
 
 		std::unique_ptr<filter_base> clone() const override;
 		const std::string type() const override { return "crop-filter"; };
-		const bool apply(cv::Mat& mat) const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
 		const bool load_json(const nlohmann::json& filter) override;
 		const nlohmann::json to_json() const override;
+		const bool output_size(const cv::Size& input, cv::Size& output) const override;
 
 	private:
+		const cv::Rect roi(const cv::Size& size) const;
+
 		filter::filter_parameter<double, 0.0, 1.0> center_x;
 		filter::filter_parameter<double, 0.0, 1.0> center_y;
 
@@ -13,7 +13,7 @@ namespace filter
 
 		std::unique_ptr<filter_base> clone() const override;
 		const std::string type() const override { return "gaussian-blur-filter"; };
-		const bool apply(cv::Mat& mat) const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
 		const bool load_json(const nlohmann::json& filter) override;
 		const nlohmann::json to_json() const override;
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Edge-preserving smoothing guided by the depth image itself or, for the intensity variant, by the
+	 * intensity channel of the camera frame. Both are registered as their own filter type so the node editor,
+	 * which only edits numbers, can offer both.
+	 */
+	class guided_filter : public filter_base
+	{
+	public:
+		guided_filter(const frame::channel guide = frame::channel::distance);
+		~guided_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_channel(frame::channel& channel) const override;
+		const bool apply_with_channel(const cv::Mat& input, const cv::Mat& channel, cv::Mat& output) const override;
+
+	private:
+		frame::channel guide;
+		filter::filter_parameter<int, 1, 64> radius;
+		filter::filter_parameter<double, 0.0, 65535.0> epsilon;
+
+		// summed area tables with one extra row and column of zeros, reused between frames
+		mutable std::vector<double> sum;
+		mutable std::vector<double> square_sum;
+		// guide and guide * input sums, only used with a separate guide
+		mutable std::vector<double> guide_sum;
+		mutable std::vector<double> cross_sum;
+		mutable std::vector<int32_t> count;
+		mutable std::vector<double> a_sum;
+		mutable std::vector<double> b_sum;
+		mutable std::vector<int32_t> ab_count;
+
+		const bool smooth(const cv::Mat& input, const cv::Mat& guide_image, cv::Mat& output) const;
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "common/include/common/filter_base.h"
 #include "common/include/common/filter_parameter.h"
 
@@ -13,11 +15,19 @@ namespace filter
 
 		std::unique_ptr<filter_base> clone() const override;
 		const std::string type() const override { return "median-filter"; };
-		const bool apply(cv::Mat& mat) const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
 		const bool load_json(const nlohmann::json& filter) override;
 		const nlohmann::json to_json() const override;
 
 	private:
-		filter::filter_parameter<int, 3, 5, true> size;
+		filter::filter_parameter<int, 3, 31, true> size;
+
+		// window histogram of 16 bit values: 'fine' counts every value, 'coarse' every block of 256 values
+		mutable std::vector<uint16_t> fine;
+		mutable std::vector<uint16_t> coarse;
+		// result of filtering in place
+		mutable std::vector<uint16_t> scratch;
+
+		void median_16u(const cv::Mat& input, cv::Mat& output) const;
 	};
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	enum class morphology_operation
+	{
+		erode,
+		dilate,
+		open,
+		close
+	};
+
+	/**
+	 * @brief Morphology on the mask of valid (non-zero) depth pixels, with a square kernel.
+	 *
+	 * Every operation is registered as its own filter type so the node editor, which only edits numbers,
+	 * can offer all of them.
+	 */
+	class morphology_filter : public filter_base
+	{
+	public:
+		morphology_filter(const morphology_operation operation = morphology_operation::erode);
+		~morphology_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+	private:
+		morphology_operation operation;
+		filter::filter_parameter<int, 3, 31, true> size;
+
+		// result of filtering in place
+		mutable std::vector<uint16_t> scratch;
+	};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Bins the world space points into a dense occupancy grid over an axis aligned box, in millimetres.
+	 *
+	 * The output has one pixel per cell holding the number of points in it, or zero if there are fewer than
+	 * 'min-count'. Columns are x cells and rows are y cells, with the z layers stacked below each other, so a
+	 * single z cell gives a 2.5D grid. Together with the "bits" PLC encoding every cell becomes one bool.
+	 */
+	class occupancy_grid_filter : public filter_base
+	{
+	public:
+		occupancy_grid_filter();
+		~occupancy_grid_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "occupancy-grid-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool output_size(const cv::Size& input, cv::Size& output) const override;
+		const bool uses_point_cloud() const override;
+		const bool apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const override;
+
+	private:
+		filter::filter_parameter<double, -100000.0, 100000.0> x_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> x_max;
+		filter::filter_parameter<double, -100000.0, 100000.0> y_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> y_max;
+		filter::filter_parameter<double, -100000.0, 100000.0> z_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> z_max;
+		filter::filter_parameter<int, 1, 1024> cells_x;
+		filter::filter_parameter<int, 1, 1024> cells_y;
+		filter::filter_parameter<int, 1, 64> cells_z;
+		filter::filter_parameter<int, 1, 65535> min_count;
+
+		mutable std::vector<uint32_t> counts;
+	};
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Keeps the rays of a polar scan, or the points of a point list, whose distance from the camera
+	 * lies in ['lower', 'upper'] millimetres. Rays outside are cleared, points outside are removed.
+	 */
+	class range_gate_filter : public filter_base
+	{
+	public:
+		range_gate_filter();
+		~range_gate_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_scan() const override;
+		const bool apply_to_scan(const frame::Scan& input, frame::Scan& output) const override;
+
+	private:
+		filter::filter_parameter<double, 0.0, 100000.0> upper;
+		filter::filter_parameter<double, 0.0, 100000.0> lower;
+	};
+}
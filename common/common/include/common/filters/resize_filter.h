@@ -9,13 +9,18 @@ namespace filter
 	{
 	public:
 		resize_filter();
+		resize_filter(const int width, const int height);
 		~resize_filter() override;
 
 		std::unique_ptr<filter_base> clone() const override;
 		const std::string type() const override { return "resize-filter"; };
-		const bool apply(cv::Mat& mat) const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
 		const bool load_json(const nlohmann::json& filter) override;
 		const nlohmann::json to_json() const override;
+		const bool output_size(const cv::Size& input, cv::Size& output) const override;
+
+		static void downsample_integer(const cv::Mat& input, cv::Mat& output, const int width, const int height);
+		static void resize_valid(const cv::Mat& input, cv::Mat& output, const int width, const int height);
 
 	private:
 		filter::filter_parameter<int, 1, std::numeric_limits<int>::max()> size_x;
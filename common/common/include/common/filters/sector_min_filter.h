@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Reduces a polar scan or point list to a polar scan of 'sectors' rays, each the distance of the
+	 * nearest measurement in its sector (0 if there is none).
+	 *
+	 * A polar scan is split into sectors of the same number of rays. Points are sorted into sectors between
+	 * 'angle.min' and 'angle.max' degrees by their angle atan2(y, x) around the camera, points outside are
+	 * dropped.
+	 */
+	class sector_min_filter : public filter_base
+	{
+	public:
+		sector_min_filter();
+		~sector_min_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_scan() const override;
+		const bool apply_to_scan(const frame::Scan& input, frame::Scan& output) const override;
+
+	private:
+		filter::filter_parameter<int, 1, 1024> sectors;
+		filter::filter_parameter<double, -180.0, 180.0> angle_min;
+		filter::filter_parameter<double, -180.0, 180.0> angle_max;
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+#include "opencv2/core/mat.hpp"
+
+namespace filter
+{
+	class temporal_hole_fill_filter : public filter_base
+	{
+	public:
+		temporal_hole_fill_filter();
+		~temporal_hole_fill_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "temporal-hole-fill-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+		void adopt_state(const filter_base& previous) override;
+
+	private:
+		filter::filter_parameter<int, 1, 1000> max_age;
+
+		// per pixel last valid value and the number of frames since it was seen
+		mutable std::vector<uint16_t> last_valid;
+		mutable std::vector<uint16_t> age;
+		mutable cv::Size size;
+	};
+}
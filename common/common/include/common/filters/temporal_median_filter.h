@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+#include "opencv2/core/mat.hpp"
+
+namespace filter
+{
+	class temporal_median_filter : public filter_base
+	{
+	public:
+		temporal_median_filter();
+		~temporal_median_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "temporal-median-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+		void adopt_state(const filter_base& previous) override;
+
+	private:
+		filter::filter_parameter<int, 3, 15, true> window_size;
+
+		// per pixel, 'window_size' consecutive entries each: the last values in arrival order and the same values sorted
+		mutable std::vector<uint16_t> history;
+		mutable std::vector<uint16_t> sorted;
+		// per pixel number of invalid (zero) values in the window, these are always at the front of 'sorted'
+		mutable std::vector<uint8_t> invalid;
+		mutable cv::Size size;
+		mutable int window;
+		mutable int head;
+		mutable int filled;
+
+		void reset(const cv::Size& new_size) const;
+	};
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	/**
+	 * @brief Voxel grid downsampling in world space: of all pixels whose points fall into the same cube of
+	 * 'voxel-size' millimetres only the one closest to the camera is kept.
+	 */
+	class voxel_filter : public filter_base
+	{
+	public:
+		voxel_filter();
+		~voxel_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override { return "voxel-filter"; };
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_point_cloud() const override;
+		const bool apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const override;
+
+	private:
+		struct voxel_pixel
+		{
+			uint64_t voxel;
+			uint16_t depth;
+			uint32_t index;
+		};
+
+		filter::filter_parameter<double, 1.0, 10000.0> size;
+
+		mutable std::vector<voxel_pixel> pixels;
+	};
+}
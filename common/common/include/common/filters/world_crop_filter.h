@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common/include/common/filter_base.h"
+#include "common/include/common/filter_parameter.h"
+
+namespace filter
+{
+	enum class world_crop_region
+	{
+		box,
+		height
+	};
+
+	/**
+	 * @brief Keeps the pixels whose world space point lies inside an axis aligned box, in millimetres.
+	 *
+	 * The height variant only limits the world z axis, for cameras with a cam2world matrix that puts z up.
+	 * Both are registered as their own filter type so the node editor, which only edits numbers, can offer
+	 * both.
+	 */
+	class world_crop_filter : public filter_base
+	{
+	public:
+		world_crop_filter(const world_crop_region region = world_crop_region::box);
+		~world_crop_filter() override;
+
+		std::unique_ptr<filter_base> clone() const override;
+		const std::string type() const override;
+		const bool apply_to(const cv::Mat& input, cv::Mat& output) const override;
+		const bool load_json(const nlohmann::json& filter) override;
+		const nlohmann::json to_json() const override;
+
+		const bool uses_point_cloud() const override;
+		const bool apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const override;
+
+	private:
+		world_crop_region region;
+		filter::filter_parameter<double, -100000.0, 100000.0> x_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> x_max;
+		filter::filter_parameter<double, -100000.0, 100000.0> y_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> y_max;
+		filter::filter_parameter<double, -100000.0, 100000.0> z_min;
+		filter::filter_parameter<double, -100000.0, 100000.0> z_max;
+	};
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "opencv2/core/mat.hpp"
+
+namespace kernels
+{
+	/**
+	 * Integer separable convolutions for single channel uint16 depth images.
+	 *
+	 * Only kernel sizes 1, 3, 5 and 7 have a specialized implementation. Each pass has its kernel size as a
+	 * template parameter so the inner loops are fully unrolled and vectorized by the compiler. Borders are
+	 * reflected like OpenCV's default (BORDER_REFLECT_101). All functions return false without touching
+	 * 'output' when there is no specialized implementation for the input, callers then fall back to OpenCV.
+	 */
+
+	const bool box_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size);
+	const bool gaussian_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size, const double sigma_x, const double sigma_y);
+	const bool stack_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size);
+}
@@ -1,34 +1,129 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "opencv2/imgproc.hpp"
 #include "opencv2/imgcodecs.hpp"
 
+#include "common/point_cloud.h"
+
 namespace frame
 {
+    /**
+     * @brief Images a camera frame can carry, all uint16 at the camera resolution.
+     */
+    enum class channel
+    {
+        distance,
+        intensity,
+        state,
+        confidence
+    };
+
+    constexpr size_t num_channels = 4;
+
+    const char* channel_name(const channel channel);
+
+    /**
+     * @brief What the processing loop takes from a camera frame: the depth image, or one of the 1D reductions
+     * a Visionary-T computes on the device.
+     */
+    enum class kind
+    {
+        image,
+        // distances along evenly spaced rays in a plane
+        polar,
+        // list of points
+        cartesian
+    };
+
+    const bool parse_kind(const std::string& name, kind& parsed);
+
+    /**
+     * @brief Polar scan or cartesian point list of a camera frame, filtered and sent to the PLC without going
+     * through the image path.
+     */
+    struct Scan
+    {
+        // polar or cartesian
+        frame::kind kind;
+        // polar: distance in mm along every ray, 0 where nothing was measured, and its confidence (may be empty)
+        std::vector<float> distance;
+        std::vector<float> confidence;
+        // polar: angle of the first ray and between two rays in rad
+        float start_angle;
+        float angular_resolution;
+        // cartesian: points in mm with their confidence
+        std::vector<visionary::PointXYZC> points;
+
+        Scan()
+            : kind(frame::kind::polar), start_angle(0.0f), angular_resolution(0.0f)
+        {
+        }
+
+        const size_t size() const;
+    };
+
+    /**
+     * @brief Hands out frame buffers and takes them back when the last frame using them is gone, so a camera
+     * streaming at a fixed resolution stops allocating after its first few frames.
+     */
+    class buffer_pool
+    {
+    public:
+        buffer_pool();
+
+        std::shared_ptr<std::vector<uint16_t>> acquire(const size_t size);
+
+    private:
+        struct free_list
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<std::vector<uint16_t>>> buffers;
+        };
+
+        // shared with the buffers handed out, which may outlive the pool
+        std::shared_ptr<free_list> _free;
+    };
+
     struct Frame
     {
-        std::vector<uint16_t> data;
+        // all channels in one buffer, one height x width plane per channel in 'channel' order. copies of a frame
+        // share the buffer, so it must not be written once the frame is filled
+        std::shared_ptr<std::vector<uint16_t>> buffer;
+        // bit (1 << channel) set for every channel in 'buffer'
+        uint32_t channels;
         uint32_t height;
         uint32_t width;
         uint32_t number;
         uint64_t time_ms;
+        // camera the frame was taken with, shared by all frames until its parameters change. null for frames not from a camera
+        std::shared_ptr<const cloud::camera_model> camera;
+        // reductions the camera computed for this frame, null if it did not send them
+        std::shared_ptr<const Scan> polar;
+        std::shared_ptr<const Scan> cartesian;
 
         Frame()
-            : height(0), width(0), number(0), time_ms(0)
+            : channels(0), height(0), width(0), number(0), time_ms(0)
         {
         }
 
         Frame(const std::vector<uint16_t>& data, const uint32_t height, const uint32_t width, const uint32_t number, const uint64_t time)
-            : data(data), height(height), width(width), number(number), time_ms(time)
+            : buffer(std::make_shared<std::vector<uint16_t>>(data)), channels(1u << static_cast<int>(channel::distance)),
+            height(height), width(width), number(number), time_ms(time)
         {
         }
 
-        bool operator==(const Frame& other) const
-        {
-            return data == other.data && height == other.height && width == other.width && number == other.number && time_ms == other.time_ms;
-        }
+        const bool has(const channel channel) const;
+        const uint16_t* data(const channel channel) const;
+        uint16_t* data(const channel channel);
+
+        bool operator==(const Frame& other) const;
     };
-    
+
     struct Size
     {
         uint32_t height, width;
@@ -38,7 +133,9 @@ namespace frame
 
     const float aspect(const Frame& frame);
 
-    const cv::Mat to_mat(const Frame& frame);
+    const cv::Mat view(const Frame& frame, const channel channel = channel::distance);
+
+    const cv::Mat to_mat(const Frame& frame, const channel channel = channel::distance);
 
     const Frame to_frame(const cv::Mat& mat);
-}
\ No newline at end of file
+}
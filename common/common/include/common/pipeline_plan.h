@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+#include "opencv2/core/mat.hpp"
+
+#include "common/filter_pipeline.h"
+#include "common/frame.h"
+#include "common/point_cloud.h"
+
+namespace filter
+{
+	/**
+	 * @brief A filter pipeline compiled for one input geometry.
+	 *
+	 * Compiling copies the pipeline, checks that every filter accepts the image its predecessor produces and
+	 * allocates one intermediate buffer per filter. Executing then only runs the filters, without parsing,
+	 * cloning or allocating. A plan stays valid until the pipeline or the input geometry changes.
+	 *
+	 * Point cloud filters (see 'filter_base::uses_point_cloud') and filters using the camera parameters (see
+	 * 'filter_base::uses_camera') need the camera set with 'set_camera' and must come before any filter
+	 * changing the image size. The points are only generated when such a filter runs
+	 * and are shared by consecutive point cloud filters.
+	 *
+	 * Filters reading another channel of the camera frame (see 'filter_base::uses_channel') get it from the
+	 * frame set with 'set_channels', without copying. They must also come before any filter changing the
+	 * image size.
+	 */
+	class pipeline_plan
+	{
+	public:
+		pipeline_plan();
+		pipeline_plan(const filter_pipeline& pipeline, const cv::Size& input_size, const int input_type);
+
+		const bool valid() const;
+		const bool compiled_for(const cv::Size& input_size, const int input_type) const;
+		const cv::Size output_size() const;
+
+		void adopt_state(const pipeline_plan& previous);
+		void set_camera(const std::shared_ptr<const cloud::camera_model>& camera);
+		void set_channels(const frame::Frame& frame);
+		const bool execute(const cv::Mat& input, cv::Mat& output) const;
+		const bool execute(const cv::Mat& input, cv::Mat& output, bool& unchanged) const;
+
+	private:
+		filter_pipeline _pipeline;
+		cv::Size _input_size;
+		int _input_type;
+		cv::Size _output_size;
+		bool _valid;
+
+		// output of every filter except the last, which writes to the caller's output
+		mutable std::vector<cv::Mat> _buffers;
+
+		std::shared_ptr<const cloud::camera_model> _camera;
+		mutable cloud::projector _projector;
+		mutable cloud::point_cloud _points;
+
+		// frame the inputs come from, shares its buffer with the caller's frame
+		frame::Frame _frame;
+
+		const bool execute(const cv::Mat& input, cv::Mat& output, bool& unchanged, const bool skip_unchanged) const;
+	};
+}
@@ -3,10 +3,32 @@
 #include <string>
 #include <vector>
 
+#include "opencv2/core/mat.hpp"
+
 #include "3pp/snap7/snap7.h"
 
+#include "common/frame.h"
+#include "common/zones.h"
+
 namespace plc
 {
+	// data type the PLC data block declares per pixel
+	enum class encoding
+	{
+		udint,
+		uint,
+		// one bool per pixel, set for non-zero pixels
+		bits
+	};
+
+	const bool parse_encoding(const std::string& name, encoding& parsed);
+	void encode(const cv::Mat& mat, const encoding data_type, std::vector<byte>& buffer);
+	void encode_udint(const cv::Mat& mat, std::vector<byte>& buffer);
+	void encode_uint(const cv::Mat& mat, std::vector<byte>& buffer);
+	void encode_bits(const cv::Mat& mat, std::vector<byte>& buffer);
+	void encode(const frame::Scan& scan, const encoding data_type, const size_t length, std::vector<byte>& buffer);
+	void encode(const std::vector<zones::zone_state>& states, const bool distances, std::vector<byte>& buffer);
+
 	class plc_handler
 	{
 	public:
@@ -17,6 +39,7 @@ namespace plc
 		const int connect();
 		const int disconnect();
 		const int write_udint(const std::vector<uint32_t>& data, const int db_number, const int db_offset_bytes);
+		const int write(const std::vector<byte>& buffer, const int db_number, const int db_offset_bytes);
 
 	private:
 		TS7Client plc;
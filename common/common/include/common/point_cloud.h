@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "opencv2/core/mat.hpp"
+
+#include "VisionaryData.h"
+
+namespace cloud
+{
+	/**
+	 * @brief What is needed to turn a depth image of one camera into points.
+	 */
+	struct camera_model
+	{
+		// intrinsics, lens distortion and cam2world matrix as read from the camera
+		visionary::CameraParameters parameters;
+		// millimetres per depth image unit
+		float distance_unit;
+		// true if depth values are distances along the ray (Visionary-T), false if they are z values (Visionary-S)
+		bool radial;
+
+		bool operator==(const camera_model& other) const;
+	};
+
+	/**
+	 * @brief World space points of a depth image in millimetres, one per pixel in row major order and stored
+	 * as structure of arrays. Invalid pixels (0 and 0xFFFF) are NaN.
+	 */
+	struct point_cloud
+	{
+		cv::Size size;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+	};
+
+	/**
+	 * @brief Converts depth images into world space point clouds.
+	 *
+	 * Uses the world space look-up table of the SICK API (see 'visionary::getWorldLut'), the one its data
+	 * handlers generate world point clouds with, and its rule for invalid pixels. Every pixel costs one
+	 * multiply-add per axis.
+	 */
+	class projector
+	{
+	public:
+		const bool project(const std::shared_ptr<const camera_model>& camera, const cv::Mat& depth, point_cloud& points);
+
+	private:
+		std::shared_ptr<const camera_model> _camera;
+		std::shared_ptr<const visionary::WorldLut> _rays;
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "common/bounded_queue.h"
+#include "common/camera_handler.h"
+#include "common/filter_pipeline.h"
+#include "common/pipeline_plan.h"
+#include "common/frame.h"
+#include "common/plc_handler.h"
+#include "common/rate_limiter.h"
+#include "common/zones.h"
+
+namespace processing
+{
+	struct loop_config
+	{
+		int db_number;
+		int db_offset_bytes;
+		int frame_width;
+		int frame_height;
+		plc::encoding encoding;
+		// polar and cartesian send 'frame_width' rays or points per frame and ignore 'frame_height'
+		frame::kind kind = frame::kind::image;
+		// if set, the state of these zones is sent instead of the image and the frame size is ignored
+		std::vector<zones::zone> zones;
+		// send the distance of the nearest pixel of every zone after the occupied bits
+		bool zone_distances = false;
+	};
+
+	const size_t frame_size_bytes(const loop_config& config);
+
+	/**
+	 * @brief Moves frames from the camera to the PLC.
+	 *
+	 * Runs as four stages (receive -> filter -> encode -> write), each on its own thread and connected by
+	 * bounded queues. Every stage blocks on its input, so a frame only waits for work that is actually
+	 * ahead of it. A full queue drops its oldest frame, so a slow stage never builds up latency.
+	 *
+	 * The loop runs its own copy of the pipeline with a final resize to the configured frame size appended.
+	 * The pipeline is compiled into a plan for the camera resolution and only recompiled when the pipeline
+	 * is replaced while running or the resolution changes. The filter stage switches over between two frames.
+	 * Frames a filter reports as unchanged (see 'filter_base::frame_unchanged') stop at the filter stage.
+	 *
+	 * For polar scans and point lists the images of the frames are not touched, the pipeline runs on the scan
+	 * directly and nothing is appended to it.
+	 *
+	 * With zones configured, the encode stage evaluates them on the filtered image (see 'zones::zone_engine')
+	 * and writes their state instead of the image. Nothing is appended to the pipeline either.
+	 */
+	class processing_loop
+	{
+	public:
+		processing_loop(camera::camera_handler& camera, plc::plc_handler& plc, const filter::filter_pipeline& pipeline, const loop_config& config);
+		~processing_loop();
+
+		const bool run(const volatile std::atomic_bool& done);
+		void set_pipeline(const filter::filter_pipeline& pipeline);
+		void set_frame_written_callback(const std::function<void(const uint32_t frame_number)>& callback);
+		void set_frame_skipped_callback(const std::function<void(const uint32_t frame_number)>& callback);
+
+	private:
+		struct filtered_frame
+		{
+			uint32_t number;
+			cv::Mat mat;
+			frame::Scan scan;
+			// needed by world space zones
+			std::shared_ptr<const cloud::camera_model> camera;
+		};
+
+		struct encoded_frame
+		{
+			uint32_t number;
+			std::vector<byte> data;
+		};
+
+		static constexpr size_t queue_capacity = 2;
+
+		camera::camera_handler& _camera;
+		plc::plc_handler& _plc;
+		const loop_config _config;
+
+		filter::filter_pipeline _pipeline;
+		filter::pipeline_plan _plan;
+		bool _plan_outdated;
+
+		std::mutex _pipeline_mutex;
+		std::unique_ptr<filter::filter_pipeline> _next_pipeline;
+		std::atomic_bool _pipeline_changed;
+
+		std::function<void(const uint32_t frame_number)> _frame_written_callback;
+		std::function<void(const uint32_t frame_number)> _frame_skipped_callback;
+
+		bounded_queue<frame::Frame> _received;
+		bounded_queue<filtered_frame> _filtered;
+		bounded_queue<encoded_frame> _encoded;
+
+		logging::rate_limiter _filter_error_limiter;
+		logging::rate_limiter _encode_error_limiter;
+
+		// only used by the encode stage
+		zones::zone_engine _zones;
+		std::vector<zones::zone_state> _zone_states;
+
+		std::atomic_bool _failed;
+		std::mutex _stop_mutex;
+		std::condition_variable _stop_cv;
+		bool _stopping;
+
+		const filter::filter_pipeline output_pipeline(const filter::filter_pipeline& pipeline) const;
+		void swap_pipeline();
+		void compile_plan(const cv::Size& input_size, const int input_type);
+
+		void run_filter();
+		void filter_scan(const frame::Frame& raw_frame);
+		void run_encode();
+		void run_write();
+
+		void stop();
+		void fail(const std::string& stage, const std::string& what);
+		const bool wait_for_stop(const std::chrono::milliseconds& timeout);
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace logging
+{
+	/**
+	 * @brief Lets one message through per interval and counts the ones held back in between.
+	 *
+	 * Used for errors that can repeat on every frame. Copies start with a fresh state so cloned
+	 * owners (e.g. filters) do not share a budget.
+	 */
+	class rate_limiter
+	{
+	public:
+		rate_limiter(const std::chrono::milliseconds& interval = std::chrono::milliseconds(1000));
+		rate_limiter(const rate_limiter& other);
+		rate_limiter& operator=(const rate_limiter& other);
+
+		const bool allow(uint64_t& suppressed);
+
+	private:
+		std::chrono::steady_clock::duration _interval;
+		std::atomic<std::chrono::steady_clock::rep> _next_allowed;
+		std::atomic<uint64_t> _suppressed;
+	};
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "opencv2/core/mat.hpp"
+
+namespace rle
+{
+	/**
+	 * @brief Horizontal run of set pixels covering columns [start, end).
+	 */
+	struct run
+	{
+		int start;
+		int end;
+	};
+
+	/**
+	 * @brief Binary mask stored as sorted, non-overlapping runs per row.
+	 *
+	 * Depth masks are mostly a few large regions plus some specks, so working on runs touches a handful of
+	 * elements per row instead of every pixel.
+	 */
+	struct run_mask
+	{
+		cv::Size size;
+		std::vector<std::vector<run>> rows;
+	};
+
+	const run_mask encode(const cv::Mat& depth);
+	const run_mask dilate(const run_mask& mask, const int radius);
+	const run_mask erode(const run_mask& mask, const int radius);
+	const uint64_t remove_small_components(run_mask& mask, const int min_area);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opencv2/core/mat.hpp"
+
+#include "json.hpp"
+
+#include "common/point_cloud.h"
+
+namespace zones
+{
+	enum class zone_shape
+	{
+		// polygon in image pixels, limited to a distance range
+		polygon,
+		// axis aligned box in world space millimetres
+		box
+	};
+
+	/**
+	 * @brief Region of the camera's view the PLC wants to know about, as read from the configuration.
+	 */
+	struct zone
+	{
+		std::string name;
+		zone_shape shape;
+		// polygon: corners in pixels of the filtered image and the distance range in mm
+		std::vector<cv::Point2f> polygon;
+		float distance_min;
+		float distance_max;
+		// box: corners in mm
+		float box_min[3];
+		float box_max[3];
+		// pixels inside the zone needed to count it as occupied
+		int min_pixels;
+	};
+
+	struct zone_state
+	{
+		bool occupied;
+		uint32_t pixels;
+		// distance of the nearest pixel inside the zone in mm, 0 if there is none
+		float min_distance;
+	};
+
+	const bool parse_zones(const nlohmann::json& zones, std::vector<zone>& parsed);
+
+	/**
+	 * @brief Evaluates zones on filtered depth images.
+	 *
+	 * Every zone is compiled once per image size and camera into the pixel runs it covers, with the range of
+	 * depth values inside the zone for every pixel. Box zones become the depth interval in which the ray of
+	 * the pixel crosses the box. A frame then costs one comparison per zone pixel and no point is computed.
+	 */
+	class zone_engine
+	{
+	public:
+		zone_engine(const std::vector<zone>& zones = {});
+
+		const bool empty() const;
+		const bool needs_camera() const;
+		const bool evaluate(const cv::Mat& depth, const std::shared_ptr<const cloud::camera_model>& camera, std::vector<zone_state>& states);
+
+	private:
+		struct span
+		{
+			int y;
+			int start;
+			int end;
+		};
+
+		struct compiled_zone
+		{
+			std::vector<span> spans;
+			// depth values inside the zone, one per pixel of 'spans' in order
+			std::vector<uint16_t> lower;
+			std::vector<uint16_t> upper;
+		};
+
+		std::vector<zone> _zones;
+		std::vector<compiled_zone> _compiled;
+		cv::Size _size;
+		std::shared_ptr<const cloud::camera_model> _camera;
+
+		const bool compile(const cv::Size& size, const std::shared_ptr<const cloud::camera_model>& camera);
+		void compile_polygon(const zone& zone, const float unit, compiled_zone& compiled) const;
+		void compile_box(const zone& zone, const visionary::WorldLut& rays, const float unit, compiled_zone& compiled) const;
+	};
+}
@@ -1,8 +1,203 @@
 #include "common/camera_handler.h"
 
+#include <algorithm>
+
 #include "spdlog/spdlog.h"
 
+#include "Framegrabber.h"
+#include "VisionarySData.h"
+#include "VisionaryTData.h"
+#include "VisionaryTMiniData.h"
+
+namespace
+{
+    // maps of the last received blob per frame channel, null for channels the camera type does not send
+    struct channel_maps
+    {
+        const std::vector<uint16_t>* maps[frame::num_channels] = {};
+        // colour image of the Visionary-S, goes into the intensity channel
+        const std::vector<uint32_t>* rgba = nullptr;
+    };
+
+    template <typename DataType>
+    struct camera_traits;
+
+    template <>
+    struct camera_traits<visionary::VisionaryTMiniData>
+    {
+        static constexpr visionary::VisionaryControl::ProtocolType protocol = visionary::VisionaryControl::ProtocolType::COLA_2;
+        static constexpr bool radial = true;
+
+        static void collect(const visionary::VisionaryTMiniData& data, channel_maps& maps)
+        {
+            maps.maps[static_cast<int>(frame::channel::distance)] = &data.getDistanceMap();
+            maps.maps[static_cast<int>(frame::channel::intensity)] = &data.getIntensityMap();
+            maps.maps[static_cast<int>(frame::channel::state)] = &data.getStateMap();
+        }
+
+        static void collect_scans(const visionary::VisionaryTMiniData& data, const frame::kind kind, frame::Frame& frame)
+        {
+        }
+    };
+
+    template <>
+    struct camera_traits<visionary::VisionarySData>
+    {
+        static constexpr visionary::VisionaryControl::ProtocolType protocol = visionary::VisionaryControl::ProtocolType::COLA_B;
+        static constexpr bool radial = false;
+
+        static void collect(const visionary::VisionarySData& data, channel_maps& maps)
+        {
+            maps.maps[static_cast<int>(frame::channel::distance)] = &data.getZMap();
+            maps.maps[static_cast<int>(frame::channel::confidence)] = &data.getConfidenceMap();
+            maps.rgba = &data.getRGBAMap();
+        }
+
+        static void collect_scans(const visionary::VisionarySData& data, const frame::kind kind, frame::Frame& frame)
+        {
+        }
+    };
+
+    template <>
+    struct camera_traits<visionary::VisionaryTData>
+    {
+        static constexpr visionary::VisionaryControl::ProtocolType protocol = visionary::VisionaryControl::ProtocolType::COLA_B;
+        static constexpr bool radial = true;
+
+        static void collect(const visionary::VisionaryTData& data, channel_maps& maps)
+        {
+            maps.maps[static_cast<int>(frame::channel::distance)] = &data.getDistanceMap();
+            maps.maps[static_cast<int>(frame::channel::intensity)] = &data.getIntensityMap();
+            maps.maps[static_cast<int>(frame::channel::confidence)] = &data.getConfidenceMap();
+        }
+
+        // the polar or cartesian reduction of 'kind', if enabled on the camera
+        static void collect_scans(const visionary::VisionaryTData& data, const frame::kind kind, frame::Frame& frame)
+        {
+            if (kind == frame::kind::polar && !data.getPolarDistanceData().empty())
+            {
+                std::shared_ptr<frame::Scan> polar = std::make_shared<frame::Scan>();
+                polar->kind = frame::kind::polar;
+                polar->distance = data.getPolarDistanceData();
+                polar->confidence = data.getPolarConfidenceData();
+                polar->start_angle = data.getPolarStartAngle();
+                polar->angular_resolution = data.getPolarAngularResolution();
+                frame.polar = std::move(polar);
+            }
+
+            if (kind == frame::kind::cartesian && !data.getCartesianData().empty())
+            {
+                std::shared_ptr<frame::Scan> cartesian = std::make_shared<frame::Scan>();
+                cartesian->kind = frame::kind::cartesian;
+                cartesian->points = data.getCartesianData();
+                frame.cartesian = std::move(cartesian);
+            }
+        }
+    };
+
+    /**
+     * @brief Luma of RGBA pixels (R in the lowest byte) scaled to the full uint16 range.
+     */
+    void rgba_to_luma(const uint32_t* rgba, const size_t count, uint16_t* luma)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t pixel = rgba[i];
+            // BT.601 weights in 1/256, they sum to 256 so white becomes 255 * 256
+            luma[i] = static_cast<uint16_t>(77 * (pixel & 0xff) + 150 * ((pixel >> 8) & 0xff) + 29 * ((pixel >> 16) & 0xff));
+        }
+    }
+}
+
+/**
+ * @brief Hides the data type of the camera from the handler, so frame grabbing and conversion are compiled
+ * per type while the rest of the handler and everything using it stay the same for all cameras.
+ */
+class camera::frame_source
+{
+public:
+    virtual ~frame_source() = default;
+
+    virtual const bool get_current() = 0;
+    virtual const bool get_next(const uint64_t timeout_ms) = 0;
+
+    virtual const visionary::VisionaryData& data() const = 0;
+    virtual const bool radial() const = 0;
+    virtual void collect(channel_maps& maps) const = 0;
+    virtual void collect_scans(const frame::kind kind, frame::Frame& frame) const = 0;
+};
+
+namespace
+{
+    template <typename DataType>
+    class typed_source : public camera::frame_source
+    {
+    public:
+        typed_source(const std::string& ip, const uint16_t port, const uint32_t timeout_ms)
+            : _frame_grabber(ip, htons(port), timeout_ms), _data_handler(std::make_shared<DataType>())
+        {
+        }
+
+        const bool get_current() override
+        {
+            return _frame_grabber.getCurrentFrame(_data_handler);
+        }
+
+        const bool get_next(const uint64_t timeout_ms) override
+        {
+            return _frame_grabber.getNextFrame(_data_handler, timeout_ms);
+        }
+
+        const visionary::VisionaryData& data() const override
+        {
+            return *_data_handler;
+        }
+
+        const bool radial() const override
+        {
+            return camera_traits<DataType>::radial;
+        }
+
+        void collect(channel_maps& maps) const override
+        {
+            camera_traits<DataType>::collect(*_data_handler, maps);
+        }
+
+        void collect_scans(const frame::kind kind, frame::Frame& frame) const override
+        {
+            camera_traits<DataType>::collect_scans(*_data_handler, kind, frame);
+        }
+
+    private:
+        visionary::FrameGrabber<DataType> _frame_grabber;
+        std::shared_ptr<DataType> _data_handler;
+    };
+
+    template <typename DataType>
+    std::unique_ptr<camera::frame_source> make_source(const std::string& ip, const uint16_t port, const uint32_t timeout_ms,
+        visionary::VisionaryControl::ProtocolType& protocol)
+    {
+        protocol = camera_traits<DataType>::protocol;
+        return std::make_unique<typed_source<DataType>>(ip, port, timeout_ms);
+    }
+}
+
+const bool camera::parse_camera_type(const std::string& name, camera_type& parsed)
+{
+    if (name == "visionary-t-mini")
+        parsed = camera_type::visionary_t_mini;
+    else if (name == "visionary-s")
+        parsed = camera_type::visionary_s;
+    else if (name == "visionary-t")
+        parsed = camera_type::visionary_t;
+    else
+        return false;
+
+    return true;
+}
+
 camera::camera_handler::camera_handler()
+    : _scan_kind(frame::kind::image)
 {
 }
 
@@ -12,19 +207,19 @@ camera::camera_handler::~camera_handler()
         _visionary_control->stopAcquisition();
 }
 
-const bool camera::camera_handler::open(const std::string& ip, const uint16_t& port, const uint32_t& timeout_ms)
+const bool camera::camera_handler::open(const std::string& ip, const uint16_t& port, const uint32_t& timeout_ms, const camera_type type)
 {
-    _frame_grabber.reset(new visionary::FrameGrabber<visionary::VisionaryTMiniData>(ip, htons(port), timeout_ms));
-    if (!_frame_grabber)
-    {
-        spdlog::get("camera")->error("Failed to create frame grabber");
-        return false;
-    }
+    visionary::VisionaryControl::ProtocolType protocol;
+    if (type == camera_type::visionary_s)
+        _source = make_source<visionary::VisionarySData>(ip, port, timeout_ms, protocol);
+    else if (type == camera_type::visionary_t)
+        _source = make_source<visionary::VisionaryTData>(ip, port, timeout_ms, protocol);
+    else
+        _source = make_source<visionary::VisionaryTMiniData>(ip, port, timeout_ms, protocol);
 
-    _data_handler.reset(new visionary::VisionaryTMiniData);
-    if (!_data_handler)
+    if (!_source)
     {
-        spdlog::get("camera")->error("Failed to create frame data buffer");
+        spdlog::get("camera")->error("Failed to create frame grabber");
         return false;
     }
 
@@ -35,7 +230,7 @@ const bool camera::camera_handler::open(const std::string& ip, const uint16_t& p
         return false;
     }
 
-    if (!_visionary_control->open(visionary::VisionaryControl::ProtocolType::COLA_2, ip, timeout_ms))
+    if (!_visionary_control->open(protocol, ip, timeout_ms))
     {
         spdlog::get("camera")->error("Failed to open camera control channel");
         return false;
@@ -59,36 +254,90 @@ const bool camera::camera_handler::open(const std::string& ip, const uint16_t& p
     return true;
 }
 
+/**
+ * @brief Selects the scan copied into every frame. The default, image, copies none.
+ */
+void camera::camera_handler::set_scan_kind(const frame::kind kind)
+{
+    _scan_kind = kind;
+}
+
 const bool camera::camera_handler::get_current_frame(frame::Frame& frame)
 {
-    if (!_frame_grabber)
+    if (!_source)
         return false;
 
-    if (!_frame_grabber->getCurrentFrame(_data_handler))
+    if (!_source->get_current())
         return false;
 
-    frame.data = _data_handler->getDistanceMap();
-    frame.height = _data_handler->getHeight();
-    frame.width = _data_handler->getWidth();
-    frame.number = _data_handler->getFrameNum();
-    frame.time_ms = _data_handler->getTimestampMS();
+    fill_frame(frame);
 
     return true;
 }
 
 const bool camera::camera_handler::get_next_frame(frame::Frame& frame, const uint64_t timeout_ms)
 {
-    if (!_frame_grabber)
+    if (!_source)
         return false;
 
-    if (!_frame_grabber->getNextFrame(_data_handler, timeout_ms))
+    if (!_source->get_next(timeout_ms))
         return false;
 
-    frame.data = _data_handler->getDistanceMap();
-    frame.height = _data_handler->getHeight();
-    frame.width = _data_handler->getWidth();
-    frame.number = _data_handler->getFrameNum();
-    frame.time_ms = _data_handler->getTimestampMS();
+    fill_frame(frame);
 
     return true;
 }
+
+void camera::camera_handler::fill_frame(frame::Frame& frame)
+{
+    const visionary::VisionaryData& data = _source->data();
+    frame.height = data.getHeight();
+    frame.width = data.getWidth();
+
+    channel_maps maps;
+    _source->collect(maps);
+
+    // every map the camera sent goes into one pooled buffer, maps missing from the blob are left out
+    const size_t num_pixels = static_cast<size_t>(frame.height) * frame.width;
+    const bool has_rgba = maps.rgba != nullptr && num_pixels > 0 && maps.rgba->size() == num_pixels;
+
+    frame.channels = 0;
+    size_t num_planes = 0;
+    for (size_t i = 0; i < frame::num_channels; ++i)
+    {
+        const bool is_rgba = i == static_cast<size_t>(frame::channel::intensity) && has_rgba;
+        if (is_rgba || (maps.maps[i] && num_pixels > 0 && maps.maps[i]->size() == num_pixels))
+        {
+            frame.channels |= 1u << i;
+            ++num_planes;
+        }
+    }
+
+    frame.buffer = _buffers.acquire(num_planes * num_pixels);
+    uint16_t* plane = frame.buffer->data();
+    for (size_t i = 0; i < frame::num_channels; ++i)
+    {
+        if (!(frame.channels & (1u << i)))
+            continue;
+
+        if (i == static_cast<size_t>(frame::channel::intensity) && has_rgba)
+            rgba_to_luma(maps.rgba->data(), num_pixels, plane);
+        else
+            std::copy(maps.maps[i]->begin(), maps.maps[i]->end(), plane);
+        plane += num_pixels;
+    }
+
+    frame.polar.reset();
+    frame.cartesian.reset();
+    if (_scan_kind != frame::kind::image)
+        _source->collect_scans(_scan_kind, frame);
+
+    frame.number = data.getFrameNum();
+    frame.time_ms = data.getTimestampMS();
+
+    // only replace the camera model when it changed, so the point cloud look-up tables built for it stay valid
+    const cloud::camera_model camera{ data.getCameraParameters(), data.getDistanceUnit(), _source->radial() };
+    if (!_camera || !(*_camera == camera))
+        _camera = std::make_shared<const cloud::camera_model>(camera);
+    frame.camera = _camera;
+}
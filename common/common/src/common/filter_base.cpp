@@ -0,0 +1,35 @@
+#include "common/filter_base.h"
+
+#include "spdlog/spdlog.h"
+
+/**
+ * @brief Applies the filter in place.
+ *
+ * @param mat Image to filter, replaced by the result on success
+ * @return True if successful, false otherwise
+ */
+const bool filter::filter_base::apply(cv::Mat& mat) const
+{
+	cv::Mat output;
+	if (!apply_to(mat, output))
+		return false;
+
+	mat = output;
+	return true;
+}
+
+/**
+ * @brief Logs a failed 'apply' at most once per second, so a filter failing on every frame does not
+ * flood the log.
+ *
+ * @param what Exception message
+ */
+void filter::filter_base::log_apply_error(const char* what) const
+{
+	uint64_t suppressed = 0;
+	if (!_apply_error_limiter.allow(suppressed))
+		return;
+
+	spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters: {}. {} similar errors suppressed",
+		type(), what, to_json()["parameters"].dump(), suppressed);
+}
@@ -1,14 +1,29 @@
 #include "common/filter_pipeline.h"
 
+#include "common/filters/angular_median_filter.h"
+#include "common/filters/background_subtraction_filter.h"
 #include "common/filters/bilateral_filter.h"
 #include "common/filters/blur_filter.h"
+#include "common/filters/cell_statistic_filter.h"
+#include "common/filters/channel_gate_filter.h"
+#include "common/filters/change_detection_filter.h"
+#include "common/filters/connected_components_filter.h"
 #include "common/filters/crop_filter.h"
 #include "common/filters/gaussian_blur_filter.h"
+#include "common/filters/guided_filter.h"
 #include "common/filters/median_filter.h"
+#include "common/filters/morphology_filter.h"
 #include "common/filters/moving_average_filter.h"
+#include "common/filters/occupancy_grid_filter.h"
+#include "common/filters/range_gate_filter.h"
 #include "common/filters/resize_filter.h"
+#include "common/filters/sector_min_filter.h"
 #include "common/filters/stack_blur_filter.h"
+#include "common/filters/temporal_hole_fill_filter.h"
+#include "common/filters/temporal_median_filter.h"
 #include "common/filters/threshold_filter.h"
+#include "common/filters/voxel_filter.h"
+#include "common/filters/world_crop_filter.h"
 
 #include "common/filter_factory.h"
 
@@ -41,6 +56,13 @@ filter::filter_pipeline& filter::filter_pipeline::operator=(const filter_pipelin
 	return *this;
 }
 
+filter::filter_pipeline& filter::filter_pipeline::operator=(filter_pipeline&& other) noexcept
+{
+	filters = std::move(other.filters);
+
+	return *this;
+}
+
 const void filter::filter_pipeline::load_json(const nlohmann::json& filters)
 {
 	this->filters.clear();
@@ -99,7 +121,86 @@ const bool filter::filter_pipeline::apply(cv::Mat& mat) const
 	}
 }
 
+/**
+ * @brief Runs all filters on a polar scan or point list. Fails if the pipeline has image filters.
+ *
+ * @param input Scan to filter
+ * @param output Filtered scan, a copy of 'input' if the pipeline is empty
+ * @return True if successful, false otherwise
+ */
+const bool filter::filter_pipeline::apply_to_scan(const frame::Scan& input, frame::Scan& output) const
+{
+	try
+	{
+		// the filters alternate between 'output' and 'buffer', so the last one writes into 'output'
+		frame::Scan buffer;
+		const frame::Scan* current = &input;
+		for (size_t i = 0; i < this->filters.size(); ++i)
+		{
+			frame::Scan& target = (this->filters.size() - i) % 2 == 1 ? output : buffer;
+			if (!this->filters[i]->apply_to_scan(*current, target))
+				return false;
+
+			current = &target;
+		}
+
+		if (current == &input)
+			output = input;
+
+		return true;
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::get("filter")->error("Exception applying filters: {}", e.what());
+
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::get("filter")->error("Unkown exception applying filters");
+
+		return false;
+	}
+}
+
 const bool filter::filter_pipeline::empty() const
 {
 	return this->filters.empty();
 }
+
+const size_t filter::filter_pipeline::size() const
+{
+	return this->filters.size();
+}
+
+const filter::filter_base& filter::filter_pipeline::at(const size_t index) const
+{
+	return *this->filters.at(index);
+}
+
+void filter::filter_pipeline::push_back(std::unique_ptr<filter_base> filter)
+{
+	this->filters.push_back(std::move(filter));
+}
+
+/**
+ * @brief Carries filter state (e.g. moving average history) over from the pipeline this one replaces.
+ *
+ * Filters are matched by position. Matching stops at the first filter whose type differs, or after the
+ * first filter whose parameters changed, because every filter after that one sees different input.
+ *
+ * @param previous Pipeline being replaced
+ */
+void filter::filter_pipeline::adopt_state(const filter_pipeline& previous)
+{
+	for (size_t i = 0; i < filters.size() && i < previous.filters.size(); ++i)
+	{
+		if (filters[i]->type() != previous.filters[i]->type())
+			break;
+
+		filters[i]->adopt_state(*previous.filters[i]);
+
+		if (filters[i]->to_json() != previous.filters[i]->to_json())
+			break;
+	}
+}
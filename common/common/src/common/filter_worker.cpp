@@ -3,7 +3,7 @@
 #include "spdlog/spdlog.h"
 
 filter::filter_worker::filter_worker()
-	: _stop(false), _new_mat(false), _thread{&filter::filter_worker::run, this}
+	: _stop(false), _new_mat(false), _pipeline_changed(false), _thread{&filter::filter_worker::run, this}
 {
 }
 
@@ -17,22 +17,25 @@ filter::filter_worker::~filter_worker()
 
 void filter::filter_worker::set_pipeline(const filter_pipeline& pipeline)
 {
+	std::lock_guard<std::mutex> locker(_pipeline_mutex);
 	this->_pipeline = pipeline;
+	_pipeline_changed = true;
 }
 
 const filter::filter_pipeline filter::filter_worker::get_pipeline() const
 {
+	std::lock_guard<std::mutex> locker(_pipeline_mutex);
 	return _pipeline;
 }
 
-const bool filter::filter_worker::try_put_new(const cv::Mat& mat)
+const bool filter::filter_worker::try_put_new(const frame::Frame& frame)
 {
 	std::unique_lock<std::mutex> locker(_mutex, std::try_to_lock);
 	if (!locker.owns_lock())
 		return false;
 
 	_new_mat = true;
-	mat.copyTo(_buffer);
+	_frame = frame;
 
 	return true;
 }
@@ -57,9 +60,26 @@ void filter::filter_worker::run()
 			_new_mat = false;
 			{
 				std::lock_guard<std::mutex> locker(_mutex);
-				if (!_pipeline.apply(_buffer))
+				const cv::Mat input = frame::view(_frame, frame::channel::distance);
+				{
+					std::lock_guard<std::mutex> pipeline_locker(_pipeline_mutex);
+					if (_pipeline_changed || !_plan.compiled_for(input.size(), input.type()))
+					{
+						pipeline_plan plan(_pipeline, input.size(), input.type());
+						plan.adopt_state(_plan);
+						_plan = std::move(plan);
+						_pipeline_changed = false;
+					}
+				}
+
+				_plan.set_camera(_frame.camera);
+				_plan.set_channels(_frame);
+
+				cv::Mat output;
+				if (!_plan.execute(input, output))
 					spdlog::get("filter")->error("Filter worker failed to apply filters");
-				_buffer.copyTo(_latest_mat);
+				else
+					output.copyTo(_latest_mat);
 			}
 		}
 		else
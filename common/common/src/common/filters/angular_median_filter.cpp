@@ -0,0 +1,124 @@
+#include "common/filters/angular_median_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+filter::angular_median_filter::angular_median_filter()
+	: radius(1)
+{
+}
+
+filter::angular_median_filter::~angular_median_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::angular_median_filter::clone() const
+{
+	return std::make_unique<filter::angular_median_filter>(*this);
+}
+
+const std::string filter::angular_median_filter::type() const
+{
+	return "angular-median-filter";
+}
+
+const bool filter::angular_median_filter::uses_scan() const
+{
+	return true;
+}
+
+const bool filter::angular_median_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("works on polar scans only");
+	return false;
+}
+
+const bool filter::angular_median_filter::apply_to_scan(const frame::Scan& input, frame::Scan& output) const
+{
+	if (input.kind != frame::kind::polar)
+	{
+		log_apply_error("works on polar scans only");
+		return false;
+	}
+
+	const int rays = static_cast<int>(input.distance.size());
+	const int r = radius.value();
+
+	output.kind = input.kind;
+	output.start_angle = input.start_angle;
+	output.angular_resolution = input.angular_resolution;
+	output.confidence = input.confidence;
+	output.points.clear();
+	output.distance.resize(rays);
+
+	float window[2 * 16 + 1];
+	for (int i = 0; i < rays; ++i)
+	{
+		if (!(input.distance[i] > 0.0f))
+		{
+			output.distance[i] = 0.0f;
+			continue;
+		}
+
+		int count = 0;
+		for (int j = std::max(i - r, 0); j <= std::min(i + r, rays - 1); ++j)
+		{
+			if (input.distance[j] > 0.0f)
+				window[count++] = input.distance[j];
+		}
+
+		// lower median for an even count, the nearer of the two middle values
+		const int middle = (count - 1) / 2;
+		std::nth_element(window, window + middle, window + count);
+		output.distance[i] = window[middle];
+	}
+
+	return true;
+}
+
+const bool filter::angular_median_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		radius = parameters["radius"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::angular_median_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"radius", radius.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,361 @@
+#include "common/filters/background_subtraction_filter.h"
+
+#include <cmath>
+
+#include "opencv2/core.hpp"
+#include "opencv2/imgcodecs.hpp"
+
+#include "spdlog/spdlog.h"
+
+filter::background_subtraction_filter::background_subtraction_filter(const background_model model)
+	: model(model), warm_up_frames(30), learned_frames(0), model_file_checked(false)
+{
+}
+
+filter::background_subtraction_filter::~background_subtraction_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::background_subtraction_filter::clone() const
+{
+	return std::make_unique<filter::background_subtraction_filter>(*this);
+}
+
+const std::string filter::background_subtraction_filter::type() const
+{
+	return model == background_model::plane ? "plane-subtraction-filter" : "background-subtraction-filter";
+}
+
+const bool filter::background_subtraction_filter::uses_camera() const
+{
+	return model == background_model::plane;
+}
+
+const bool filter::background_subtraction_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	return subtract(input, nullptr, output);
+}
+
+const bool filter::background_subtraction_filter::apply_with_camera(const cv::Mat& input, const cloud::camera_model& camera, cv::Mat& output) const
+{
+	return subtract(input, &camera, output);
+}
+
+/**
+ * @brief Learns the background or subtracts it from 'input'.
+ *
+ * @param camera Camera of the input, only needed to fit the plane model. May be null
+ */
+const bool filter::background_subtraction_filter::subtract(const cv::Mat& input, const cloud::camera_model* camera, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		if (input.size() != size)
+		{
+			reset();
+			size = input.size();
+		}
+
+		if (background.empty() && !model_file_checked)
+		{
+			model_file_checked = true;
+			load_model(input.size());
+		}
+
+		if (background.empty())
+		{
+			learn(input);
+			if (learned_frames >= warm_up_frames.value())
+				finish_learning(camera);
+
+			output.create(input.size(), CV_16UC1);
+			output.setTo(0);
+			return true;
+		}
+
+		// pixels below the background, invalid pixels and pixels without background become zero
+		output.create(input.size(), CV_16UC1);
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const uint16_t* background_row = background.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			for (int x = 0; x < input.cols; ++x)
+				out_row[x] = in_row[x] != 0 && background_row[x] > in_row[x] ? background_row[x] - in_row[x] : 0;
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+void filter::background_subtraction_filter::reset() const
+{
+	sum.clear();
+	count.clear();
+	learned_frames = 0;
+	background.release();
+	model_file_checked = false;
+}
+
+void filter::background_subtraction_filter::learn(const cv::Mat& input) const
+{
+	const size_t num_pixels = static_cast<size_t>(input.total());
+	sum.resize(num_pixels, 0);
+	count.resize(num_pixels, 0);
+
+	for (int y = 0; y < input.rows; ++y)
+	{
+		const uint16_t* row = input.ptr<uint16_t>(y);
+		uint32_t* sum_row = &sum[static_cast<size_t>(y) * input.cols];
+		uint16_t* count_row = &count[static_cast<size_t>(y) * input.cols];
+		for (int x = 0; x < input.cols; ++x)
+		{
+			sum_row[x] += row[x];
+			count_row[x] += row[x] != 0;
+		}
+	}
+
+	++learned_frames;
+}
+
+/**
+ * @brief Turns the warm-up sums into the background: the mean valid depth per pixel, or for the plane
+ * model the plane fitted to those means.
+ */
+void filter::background_subtraction_filter::finish_learning(const cloud::camera_model* camera) const
+{
+	cv::Mat mean(size, CV_16UC1);
+	for (int y = 0; y < size.height; ++y)
+	{
+		uint16_t* row = mean.ptr<uint16_t>(y);
+		for (int x = 0; x < size.width; ++x)
+		{
+			const size_t i = static_cast<size_t>(y) * size.width + x;
+			row[x] = count[i] > 0 ? static_cast<uint16_t>((sum[i] + count[i] / 2) / count[i]) : 0;
+		}
+	}
+
+	sum.clear();
+	count.clear();
+
+	if (model == background_model::plane)
+	{
+		if (!camera)
+			spdlog::error("'{}' filter needs the camera parameters to fit a plane. Using the mean depth per pixel instead", type());
+		else if (!fit_plane(*camera, mean))
+			spdlog::error("'{}' filter could not fit a plane, too few valid pixels. Using the mean depth per pixel instead", type());
+	}
+
+	background = mean;
+	spdlog::info("'{}' filter learned its background from {} frames", type(), learned_frames);
+
+	save_model();
+}
+
+/**
+ * @brief Replaces 'mean' by the plane fitted to it.
+ *
+ * A point seen at distance d along the ray r of its pixel lies on the plane n * p = k if 1 / d = r * n / k,
+ * for radial and planar depth alike (the ray cross offset only changes k). So 1 / d is fitted as a linear
+ * function of the ray, weighted by d^4 to minimize the error in depth rather than in inverse depth, and the
+ * background of every pixel is the distance at which its ray meets the plane. Rays parallel to or pointing
+ * away from the plane have no background.
+ *
+ * @return False if the valid pixels do not determine a plane
+ */
+const bool filter::background_subtraction_filter::fit_plane(const cloud::camera_model& camera, cv::Mat& mean) const
+{
+	// directions of the shared lens look-up table, times 1000 they have z = 1 for planar and unit length for radial depth
+	const std::shared_ptr<const visionary::UndistortionLut> rays = visionary::getUndistortionLut(camera.parameters, camera.radial);
+	if (rays->width != size.width || rays->height != size.height)
+		return false;
+
+	// normal equations a * theta = b
+	double a[3][3] = {};
+	double b[3] = {};
+	double n = 0.0;
+	for (int y = 0; y < size.height; ++y)
+	{
+		const uint16_t* row = mean.ptr<uint16_t>(y);
+		for (int x = 0; x < size.width; ++x)
+		{
+			if (row[x] == 0)
+				continue;
+
+			const size_t i = static_cast<size_t>(y) * size.width + x;
+			const double r[3] = { rays->x[i] * 1000.0, rays->y[i] * 1000.0, rays->z[i] * 1000.0 };
+			const double d = row[x];
+			const double w = d * d * d * d;
+			for (int j = 0; j < 3; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+					a[j][k] += w * r[j] * r[k];
+				b[j] += w * r[j] / d;
+			}
+			n += 1.0;
+		}
+	}
+
+	const auto det3 = [](const double m[3][3]) {
+		return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+			+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	};
+
+	// singular when the valid pixels lie on a line
+	const double det = det3(a);
+	if (n < 3.0 || std::abs(det) <= 1e-12 * a[0][0] * a[1][1] * a[2][2])
+		return false;
+
+	// Cramer's rule
+	double theta[3];
+	for (int column = 0; column < 3; ++column)
+	{
+		double replaced[3][3];
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int k = 0; k < 3; ++k)
+				replaced[j][k] = k == column ? b[j] : a[j][k];
+		}
+		theta[column] = det3(replaced) / det;
+	}
+
+	for (int y = 0; y < size.height; ++y)
+	{
+		uint16_t* row = mean.ptr<uint16_t>(y);
+		for (int x = 0; x < size.width; ++x)
+		{
+			const size_t i = static_cast<size_t>(y) * size.width + x;
+			const double inverse = (rays->x[i] * theta[0] + rays->y[i] * theta[1] + rays->z[i] * theta[2]) * 1000.0;
+			const double d = inverse > 0.0 ? 1.0 / inverse : 0.0;
+			row[x] = d < 65535.0 ? static_cast<uint16_t>(d + 0.5) : 0;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Loads the background from 'model_file' if it exists and matches the input size.
+ */
+const bool filter::background_subtraction_filter::load_model(const cv::Size& input_size) const
+{
+	if (model_file.empty())
+		return false;
+
+	const cv::Mat loaded = cv::imread(model_file, cv::IMREAD_UNCHANGED);
+	if (loaded.empty())
+		return false;
+
+	if (loaded.type() != CV_16UC1 || loaded.size() != input_size)
+	{
+		spdlog::warn("'{}' filter ignores background model '{}', it does not match the {}x{} input", type(), model_file, input_size.width, input_size.height);
+		return false;
+	}
+
+	background = loaded;
+	spdlog::info("'{}' filter loaded its background from '{}'", type(), model_file);
+
+	return true;
+}
+
+void filter::background_subtraction_filter::save_model() const
+{
+	if (model_file.empty())
+		return;
+
+	try
+	{
+		if (!cv::imwrite(model_file, background))
+			spdlog::error("'{}' filter failed to save its background to '{}'", type(), model_file);
+	}
+	catch (const cv::Exception& e)
+	{
+		spdlog::error("'{}' filter failed to save its background to '{}': {}", type(), model_file, e.what());
+	}
+}
+
+void filter::background_subtraction_filter::adopt_state(const filter_base& previous)
+{
+	const background_subtraction_filter* other = dynamic_cast<const background_subtraction_filter*>(&previous);
+	if (!other || other->model != model || other->warm_up_frames.value() != warm_up_frames.value() || other->model_file != model_file)
+		return;
+
+	sum = other->sum;
+	count = other->count;
+	size = other->size;
+	learned_frames = other->learned_frames;
+	background = other->background;
+	model_file_checked = other->model_file_checked;
+}
+
+const bool filter::background_subtraction_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		const int previous_warm_up = warm_up_frames.value();
+		warm_up_frames = parameters["warm-up-frames"].get<int>();
+		// optional, and kept when missing because the node editor only passes numbers back
+		if (parameters.contains("model-file"))
+			model_file = parameters["model-file"].get<std::string>();
+
+		// learn again with the new warm-up length
+		if (warm_up_frames.value() != previous_warm_up)
+			reset();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::background_subtraction_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"warm-up-frames", warm_up_frames.value()},
+			}}
+		};
+		if (!model_file.empty())
+			j["parameters"]["model-file"] = model_file;
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -2,6 +2,8 @@
 
 #include "opencv2/imgproc.hpp"
 
+#include "common/fixed_point_kernels.h"
+
 #include "spdlog/spdlog.h"
 
 filter::blur_filter::blur_filter()
@@ -17,24 +19,23 @@ std::unique_ptr<filter::filter_base> filter::blur_filter::clone() const
 	return std::make_unique<filter::blur_filter>(*this);
 }
 
-const bool filter::blur_filter::apply(cv::Mat& mat) const
+const bool filter::blur_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
-
-		cv::blur(mat, output, cv::Size(size_x.value(), size_y.value()));
-		mat = output;
+		const cv::Size size(size_x.value(), size_y.value());
+		// small kernels on uint16 depth avoid OpenCV's generic filter setup, which dominates on small frames
+		if (!kernels::box_blur(input, output, size))
+			cv::blur(input, output, size);
 
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
@@ -0,0 +1,213 @@
+#include "common/filters/cell_statistic_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+filter::cell_statistic_filter::cell_statistic_filter(const cell_statistic statistic)
+	: statistic(statistic), cells_x(10), cells_y(10), percentile(10.0)
+{
+}
+
+filter::cell_statistic_filter::~cell_statistic_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::cell_statistic_filter::clone() const
+{
+	return std::make_unique<filter::cell_statistic_filter>(*this);
+}
+
+const std::string filter::cell_statistic_filter::type() const
+{
+	switch (statistic)
+	{
+	case cell_statistic::max:
+		return "cell-max-filter";
+	case cell_statistic::mean:
+		return "cell-mean-filter";
+	case cell_statistic::percentile:
+		return "cell-percentile-filter";
+	case cell_statistic::count:
+		return "cell-count-filter";
+	case cell_statistic::min:
+	default:
+		return "cell-min-filter";
+	}
+}
+
+const bool filter::cell_statistic_filter::output_size(const cv::Size& input, cv::Size& output) const
+{
+	// every cell needs at least one pixel
+	if (input.width < cells_x.value() || input.height < cells_y.value())
+		return false;
+
+	output = cv::Size(cells_x.value(), cells_y.value());
+	return true;
+}
+
+/**
+ * @brief Computes the statistic of every cell in a single pass over the image. Cell borders are spread
+ * evenly, so cells differ in size by at most one pixel per direction.
+ */
+const bool filter::cell_statistic_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		cv::Size size;
+		if (!output_size(input.size(), size))
+		{
+			log_apply_error("more cells than pixels");
+			return false;
+		}
+
+		const size_t num_cells = static_cast<size_t>(size.area());
+		cell_of_column.resize(input.cols);
+		for (int x = 0; x < input.cols; ++x)
+			cell_of_column[x] = static_cast<int>(static_cast<int64_t>(x) * size.width / input.cols);
+
+		min.assign(num_cells, std::numeric_limits<uint16_t>::max());
+		max.assign(num_cells, 0);
+		sum.assign(num_cells, 0);
+		count.assign(num_cells, 0);
+		const bool collect = statistic == cell_statistic::percentile;
+		if (collect)
+		{
+			values.resize(num_cells);
+			for (std::vector<uint16_t>& cell_values : values)
+				cell_values.clear();
+		}
+
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* row = input.ptr<uint16_t>(y);
+			const size_t first_cell = static_cast<size_t>(static_cast<int64_t>(y) * size.height / input.rows) * size.width;
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const uint16_t value = row[x];
+				if (value == 0)
+					continue;
+
+				const size_t cell = first_cell + cell_of_column[x];
+				min[cell] = std::min(min[cell], value);
+				max[cell] = std::max(max[cell], value);
+				sum[cell] += value;
+				++count[cell];
+				if (collect)
+					values[cell].push_back(value);
+			}
+		}
+
+		output.create(size, CV_16UC1);
+		uint16_t* out = output.ptr<uint16_t>(0);
+		for (size_t cell = 0; cell < num_cells; ++cell)
+		{
+			const uint32_t n = count[cell];
+			if (statistic == cell_statistic::count)
+			{
+				out[cell] = static_cast<uint16_t>(std::min<uint32_t>(n, std::numeric_limits<uint16_t>::max()));
+				continue;
+			}
+			if (n == 0)
+			{
+				out[cell] = 0;
+				continue;
+			}
+
+			switch (statistic)
+			{
+			case cell_statistic::min:
+				out[cell] = min[cell];
+				break;
+			case cell_statistic::max:
+				out[cell] = max[cell];
+				break;
+			case cell_statistic::mean:
+				out[cell] = static_cast<uint16_t>((sum[cell] + n / 2) / n);
+				break;
+			case cell_statistic::percentile:
+			{
+				// nearest rank
+				std::vector<uint16_t>& cell_values = values[cell];
+				const size_t rank = static_cast<size_t>(percentile.value() / 100.0 * (n - 1) + 0.5);
+				std::nth_element(cell_values.begin(), cell_values.begin() + rank, cell_values.end());
+				out[cell] = cell_values[rank];
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::cell_statistic_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		cells_x = parameters["cells"]["x"].get<int>();
+		cells_y = parameters["cells"]["y"].get<int>();
+		if (statistic == cell_statistic::percentile)
+			percentile = parameters["percentile"].get<double>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::cell_statistic_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"cells", {
+					{"x", cells_x.value()},
+					{"y", cells_y.value()},
+				}}
+			}}
+		};
+		if (statistic == cell_statistic::percentile)
+			j["parameters"]["percentile"] = percentile.value();
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,151 @@
+#include "common/filters/change_detection_filter.h"
+
+#include <cstdlib>
+
+#include "spdlog/spdlog.h"
+
+filter::change_detection_filter::change_detection_filter()
+	: threshold(5.0), step(4), max_skip(30), skipped(0), unchanged(false)
+{
+}
+
+filter::change_detection_filter::~change_detection_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::change_detection_filter::clone() const
+{
+	return std::make_unique<filter::change_detection_filter>(*this);
+}
+
+const bool filter::change_detection_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		unchanged = false;
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		const int s = step.value();
+		const size_t samples_x = static_cast<size_t>((input.cols + s - 1) / s);
+		const size_t samples_y = static_cast<size_t>((input.rows + s - 1) / s);
+		const bool comparable = input.size() == size && reference.size() == samples_x * samples_y;
+
+		// sum of absolute differences, a pixel turning valid or invalid counts with its full depth
+		uint64_t difference = 0;
+		if (comparable)
+		{
+			const uint16_t* previous = reference.data();
+			for (int y = 0; y < input.rows; y += s)
+			{
+				const uint16_t* row = input.ptr<uint16_t>(y);
+				for (int x = 0; x < input.cols; x += s)
+					difference += static_cast<uint64_t>(std::abs(static_cast<int>(row[x]) - static_cast<int>(*previous++)));
+			}
+		}
+
+		const double mean_difference = comparable ? static_cast<double>(difference) / reference.size() : 0.0;
+		unchanged = comparable && mean_difference <= threshold.value() && skipped < max_skip.value();
+
+		if (unchanged)
+		{
+			++skipped;
+		}
+		else
+		{
+			// only changed frames become the new reference, so slow drifts still add up to a change
+			size = input.size();
+			reference.resize(samples_x * samples_y);
+			uint16_t* sample = reference.data();
+			for (int y = 0; y < input.rows; y += s)
+			{
+				const uint16_t* row = input.ptr<uint16_t>(y);
+				for (int x = 0; x < input.cols; x += s)
+					*sample++ = row[x];
+			}
+			skipped = 0;
+		}
+
+		input.copyTo(output);
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::change_detection_filter::frame_unchanged() const
+{
+	return unchanged;
+}
+
+void filter::change_detection_filter::adopt_state(const filter_base& previous)
+{
+	const change_detection_filter* other = dynamic_cast<const change_detection_filter*>(&previous);
+	if (!other || other->step.value() != step.value())
+		return;
+
+	reference = other->reference;
+	size = other->size;
+	skipped = other->skipped;
+}
+
+const bool filter::change_detection_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		threshold = parameters["threshold"].get<double>();
+		step = parameters["step"].get<int>();
+		max_skip = parameters["max-skip"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::change_detection_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"threshold", threshold.value()},
+				{"step", step.value()},
+				{"max-skip", max_skip.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
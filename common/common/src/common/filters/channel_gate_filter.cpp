@@ -0,0 +1,142 @@
+#include "common/filters/channel_gate_filter.h"
+
+#include "spdlog/spdlog.h"
+
+filter::channel_gate_filter::channel_gate_filter(const frame::channel channel)
+	: channel(channel), upper(65535), lower(0)
+{
+	// a clear state map means the camera had no complaints about the pixel
+	if (channel == frame::channel::state)
+		upper = 0;
+	// zero confidence means the camera could not measure the pixel
+	else if (channel == frame::channel::confidence)
+		lower = 1;
+	else
+		lower = 100;
+}
+
+filter::channel_gate_filter::~channel_gate_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::channel_gate_filter::clone() const
+{
+	return std::make_unique<filter::channel_gate_filter>(*this);
+}
+
+const std::string filter::channel_gate_filter::type() const
+{
+	return std::string(frame::channel_name(channel)) + "-gate-filter";
+}
+
+const bool filter::channel_gate_filter::uses_channel(frame::channel& channel) const
+{
+	channel = this->channel;
+	return true;
+}
+
+const bool filter::channel_gate_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("needs another channel of the camera frame");
+	return false;
+}
+
+const bool filter::channel_gate_filter::apply_with_channel(const cv::Mat& input, const cv::Mat& channel, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		if (channel.size() != input.size() || channel.type() != CV_16UC1)
+		{
+			log_apply_error(("needs the " + std::string(frame::channel_name(this->channel)) + " channel of the camera frame").c_str());
+			return false;
+		}
+
+		const uint16_t low = static_cast<uint16_t>(lower.value());
+		const uint16_t high = static_cast<uint16_t>(upper.value());
+
+		output.create(input.size(), CV_16UC1);
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const uint16_t* channel_row = channel.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const bool keep = channel_row[x] >= low && channel_row[x] <= high;
+				out_row[x] = keep ? in_row[x] : 0;
+			}
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::channel_gate_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		upper = parameters["upper"].get<int>();
+		lower = parameters["lower"].get<int>();
+
+		if (upper.value() < lower.value())
+		{
+			const auto upper_temp = upper;
+			upper = lower.value();
+			lower = upper_temp.value();
+		}
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::channel_gate_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"upper", upper.value()},
+				{"lower", lower.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,114 @@
+#include "common/filters/connected_components_filter.h"
+
+#include <algorithm>
+
+#include "common/run_length.h"
+
+#include "spdlog/spdlog.h"
+
+filter::connected_components_filter::connected_components_filter()
+	: min_area(1)
+{
+}
+
+filter::connected_components_filter::~connected_components_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::connected_components_filter::clone() const
+{
+	return std::make_unique<filter::connected_components_filter>(*this);
+}
+
+/**
+ * @brief Invalidates islands of valid (non-zero) pixels smaller than 'min-area' pixels. Pixels touching
+ * diagonally belong to the same island.
+ */
+const bool filter::connected_components_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		rle::run_mask mask = rle::encode(input);
+		rle::remove_small_components(mask, min_area.value());
+
+		// every pixel only depends on itself, so this also works in place
+		output.create(input.size(), CV_16UC1);
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			int x = 0;
+			for (const rle::run& r : mask.rows[y])
+			{
+				std::fill(out_row + x, out_row + r.start, uint16_t(0));
+				if (out_row != in_row)
+					std::copy(in_row + r.start, in_row + r.end, out_row + r.start);
+				x = r.end;
+			}
+			std::fill(out_row + x, out_row + input.cols, uint16_t(0));
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::connected_components_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		min_area = parameters["min-area"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::connected_components_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"min-area", min_area.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -17,54 +17,66 @@ std::unique_ptr<filter::filter_base> filter::crop_filter::clone() const
 	return std::make_unique<crop_filter>(*this);
 }
 
-const bool filter::crop_filter::apply(cv::Mat& mat) const
+const bool filter::crop_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
+		const cv::Rect region = roi(input.size());
 
-		// crop start
+		SPDLOG_LOGGER_DEBUG(spdlog::get("filter"), "roi.x: {}, roi.y: {}, roi.width: {}, roi.height: {}, m.cols: {}, m.rows: {}",
+			region.x, region.y, region.width, region.height, input.cols, input.rows);
 
-		int x = static_cast<int>(mat.cols * center_x.value() - width.value() * mat.cols / 2);
-		int y = static_cast<int>(mat.rows * center_y.value() - height.value() * mat.rows / 2);
-		int crop_width = static_cast<int>(mat.cols * width.value());
-		int crop_height = static_cast<int>(mat.rows * height.value());
-
-		// ensure the crop region is within the image bounds
-		x = std::max(x, 0);
-		y = std::max(y, 0);
-		crop_width = std::min(crop_width, mat.cols - x);
-		crop_height = std::min(crop_height, mat.rows - y);
-
-		// limit smallest roi
-		crop_width = std::max(1, crop_width);
-		crop_height = std::max(1, crop_height);
-
-		cv::Rect roi(x, y, crop_width, crop_height);
-
-		spdlog::debug("roi.x: {}, roi.y: {}, roi.width: {}, roi.height: {}, m.cols: {}, m.rows: {}",
-			roi.x, roi.y, roi.width, roi.height, mat.cols, mat.rows);
-
-		output = mat(roi);
-
-		// crop end
-
-		mat = output;
+		// copy instead of referencing the input so the output owns its data
+		input(region).copyTo(output);
 
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
 }
 
+const bool filter::crop_filter::output_size(const cv::Size& input, cv::Size& output) const
+{
+	if (input.empty())
+		return false;
+
+	output = roi(input).size();
+	return true;
+}
+
+/**
+ * @brief Crop region for an image of the given size, clamped to the image bounds.
+ *
+ * @param size Input image size
+ * @return Crop region, at least 1x1
+ */
+const cv::Rect filter::crop_filter::roi(const cv::Size& size) const
+{
+	int x = static_cast<int>(size.width * center_x.value() - width.value() * size.width / 2);
+	int y = static_cast<int>(size.height * center_y.value() - height.value() * size.height / 2);
+	int crop_width = static_cast<int>(size.width * width.value());
+	int crop_height = static_cast<int>(size.height * height.value());
+
+	// ensure the crop region is within the image bounds
+	x = std::max(x, 0);
+	y = std::max(y, 0);
+	crop_width = std::min(crop_width, size.width - x);
+	crop_height = std::min(crop_height, size.height - y);
+
+	// limit smallest roi
+	crop_width = std::max(1, crop_width);
+	crop_height = std::max(1, crop_height);
+
+	return cv::Rect(x, y, crop_width, crop_height);
+}
+
 const bool filter::crop_filter::load_json(const nlohmann::json& filter)
 {
 	try
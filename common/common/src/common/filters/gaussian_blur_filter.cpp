@@ -2,6 +2,8 @@
 
 #include "opencv2/imgproc.hpp"
 
+#include "common/fixed_point_kernels.h"
+
 #include "spdlog/spdlog.h"
 
 filter::gaussian_blur_filter::gaussian_blur_filter()
@@ -17,24 +19,22 @@ std::unique_ptr<filter::filter_base> filter::gaussian_blur_filter::clone() const
 	return std::make_unique<filter::gaussian_blur_filter>(*this);
 }
 
-const bool filter::gaussian_blur_filter::apply(cv::Mat& mat) const
+const bool filter::gaussian_blur_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
 		cv::Size size(size_x.value(), size_y.value());
-		cv::GaussianBlur(mat, output, size, sigma_x.value(), sigma_y.value());
+		if (!kernels::gaussian_blur(input, output, size, sigma_x.value(), sigma_y.value()))
+			cv::GaussianBlur(input, output, size, sigma_x.value(), sigma_y.value());
 
-		mat = output;
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
@@ -0,0 +1,271 @@
+#include "common/filters/guided_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	/**
+	 * @brief Sum over the rectangle [x0, x1) x [y0, y1) of a summed area table with 'stride' columns.
+	 */
+	template<typename T>
+	inline T box_sum(const std::vector<T>& table, const size_t stride, const int x0, const int y0, const int x1, const int y1)
+	{
+		return table[y1 * stride + x1] - table[y0 * stride + x1] - table[y1 * stride + x0] + table[y0 * stride + x0];
+	}
+}
+
+filter::guided_filter::guided_filter(const frame::channel guide)
+	: guide(guide), radius(4), epsilon(20.0)
+{
+}
+
+filter::guided_filter::~guided_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::guided_filter::clone() const
+{
+	return std::make_unique<guided_filter>(*this);
+}
+
+const std::string filter::guided_filter::type() const
+{
+	return guide == frame::channel::intensity ? "intensity-guided-filter" : "guided-filter";
+}
+
+const bool filter::guided_filter::uses_channel(frame::channel& channel) const
+{
+	channel = guide;
+	return guide != frame::channel::distance;
+}
+
+const bool filter::guided_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	if (guide != frame::channel::distance)
+	{
+		log_apply_error("needs the intensity channel of the camera frame");
+		return false;
+	}
+
+	return smooth(input, input, output);
+}
+
+const bool filter::guided_filter::apply_with_channel(const cv::Mat& input, const cv::Mat& channel, cv::Mat& output) const
+{
+	if (channel.size() != input.size() || channel.type() != CV_16UC1)
+	{
+		log_apply_error("needs the intensity channel of the camera frame");
+		return false;
+	}
+
+	return smooth(input, channel, output);
+}
+
+/**
+ * @brief Edge-preserving smoothing of a depth image (He et al., "Guided Image Filtering").
+ *
+ * Every window is fitted with a linear model q = a * I + b of the guide image I. Where the guide varies
+ * much more than 'epsilon' (an edge) the depth follows the guide's edges, in flat regions a approaches 0
+ * and the window mean is used. Guided by the depth itself, a is variance / (variance + epsilon^2). All
+ * window statistics come from summed area tables, so the cost per pixel does not depend on 'radius'.
+ * Invalid (zero) pixels are left out of every statistic and stay zero.
+ *
+ * @param guide_image The input itself or a CV_16UC1 image of the same size
+ */
+const bool filter::guided_filter::smooth(const cv::Mat& input, const cv::Mat& guide_image, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		// a separate guide needs its own sums, the depth itself reuses the input sums
+		const bool joint = guide_image.data != input.data;
+
+		const int cols = input.cols;
+		const int rows = input.rows;
+		const int r = radius.value();
+		const double eps = epsilon.value() * epsilon.value();
+		const size_t stride = static_cast<size_t>(cols) + 1;
+		const size_t table_size = stride * (static_cast<size_t>(rows) + 1);
+
+		sum.assign(table_size, 0.0);
+		square_sum.assign(table_size, 0.0);
+		count.assign(table_size, 0);
+		a_sum.assign(table_size, 0.0);
+		b_sum.assign(table_size, 0.0);
+		ab_count.assign(table_size, 0);
+		if (joint)
+		{
+			guide_sum.assign(table_size, 0.0);
+			cross_sum.assign(table_size, 0.0);
+		}
+
+		// window statistics of the valid pixels, zeros add nothing to the sums so only the count and the
+		// guide need a mask. 'square_sum' holds the squared guide
+		for (int y = 0; y < rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const uint16_t* guide_row = guide_image.ptr<uint16_t>(y);
+			double row_sum = 0.0, row_square_sum = 0.0, row_guide_sum = 0.0, row_cross_sum = 0.0;
+			int32_t row_count = 0;
+			for (int x = 0; x < cols; ++x)
+			{
+				const double value = in_row[x];
+				row_sum += value;
+				row_count += in_row[x] != 0;
+
+				const size_t i = (y + 1) * stride + x + 1;
+				if (joint)
+				{
+					const double g = in_row[x] != 0 ? guide_row[x] : 0.0;
+					row_guide_sum += g;
+					row_square_sum += g * g;
+					row_cross_sum += g * value;
+					guide_sum[i] = guide_sum[i - stride] + row_guide_sum;
+					cross_sum[i] = cross_sum[i - stride] + row_cross_sum;
+				}
+				else
+				{
+					row_square_sum += value * value;
+				}
+
+				sum[i] = sum[i - stride] + row_sum;
+				square_sum[i] = square_sum[i - stride] + row_square_sum;
+				count[i] = count[i - stride] + row_count;
+			}
+		}
+
+		// linear coefficients per window, accumulated straight into their own tables
+		for (int y = 0; y < rows; ++y)
+		{
+			const int y0 = std::max(y - r, 0);
+			const int y1 = std::min(y + r + 1, rows);
+			double row_a = 0.0, row_b = 0.0;
+			int32_t row_count = 0;
+			for (int x = 0; x < cols; ++x)
+			{
+				const int x0 = std::max(x - r, 0);
+				const int x1 = std::min(x + r + 1, cols);
+
+				const int32_t n = box_sum(count, stride, x0, y0, x1, y1);
+				if (n > 0)
+				{
+					const double mean = box_sum(sum, stride, x0, y0, x1, y1) / n;
+					if (joint)
+					{
+						const double guide_mean = box_sum(guide_sum, stride, x0, y0, x1, y1) / n;
+						const double variance = std::max(box_sum(square_sum, stride, x0, y0, x1, y1) / n - guide_mean * guide_mean, 0.0);
+						const double covariance = box_sum(cross_sum, stride, x0, y0, x1, y1) / n - guide_mean * mean;
+						const double a = covariance / (variance + eps);
+						row_a += a;
+						row_b += mean - a * guide_mean;
+					}
+					else
+					{
+						const double variance = std::max(box_sum(square_sum, stride, x0, y0, x1, y1) / n - mean * mean, 0.0);
+						const double a = variance / (variance + eps);
+						row_a += a;
+						row_b += (1.0 - a) * mean;
+					}
+					++row_count;
+				}
+
+				const size_t i = (y + 1) * stride + x + 1;
+				a_sum[i] = a_sum[i - stride] + row_a;
+				b_sum[i] = b_sum[i - stride] + row_b;
+				ab_count[i] = ab_count[i - stride] + row_count;
+			}
+		}
+
+		output.create(input.size(), CV_16UC1);
+		for (int y = 0; y < rows; ++y)
+		{
+			const int y0 = std::max(y - r, 0);
+			const int y1 = std::min(y + r + 1, rows);
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const uint16_t* guide_row = guide_image.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			for (int x = 0; x < cols; ++x)
+			{
+				if (in_row[x] == 0)
+				{
+					out_row[x] = 0;
+					continue;
+				}
+
+				const int x0 = std::max(x - r, 0);
+				const int x1 = std::min(x + r + 1, cols);
+
+				// a valid pixel lies in its own window, so at least one window around it has coefficients
+				const double n = box_sum(ab_count, stride, x0, y0, x1, y1);
+				const double q = (box_sum(a_sum, stride, x0, y0, x1, y1) * guide_row[x] + box_sum(b_sum, stride, x0, y0, x1, y1)) / n;
+				out_row[x] = cv::saturate_cast<uint16_t>(q);
+			}
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::guided_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		radius = parameters["radius"].get<int>();
+		epsilon = parameters["epsilon"].get<double>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::guided_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"radius", radius.value()},
+				{"epsilon", epsilon.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
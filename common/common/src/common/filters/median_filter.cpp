@@ -1,9 +1,17 @@
 #include "common/filters/median_filter.h"
 
+#include <algorithm>
+
 #include "opencv2/imgproc.hpp"
 
 #include "spdlog/spdlog.h"
 
+namespace
+{
+	constexpr int value_count = 1 << 16;
+	constexpr int block_size = 256;
+}
+
 filter::median_filter::median_filter()
 {
 }
@@ -17,29 +25,167 @@ std::unique_ptr<filter::filter_base> filter::median_filter::clone() const
 	return std::make_unique<filter::median_filter>(*this);
 }
 
-const bool filter::median_filter::apply(cv::Mat& mat) const
+const bool filter::median_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
-		cv::medianBlur(mat, output, size.value());
-
-		mat = output;
+		// cv::medianBlur counts invalid pixels as values and only supports kernels larger than 5 on 8 bit data
+		if (input.type() == CV_16UC1)
+		{
+			median_16u(input, output);
+		}
+		else if (input.depth() == CV_8U || size.value() <= 5)
+		{
+			cv::medianBlur(input, output, size.value());
+		}
+		else
+		{
+			log_apply_error("kernels larger than 5 need 8 or 16 bit unsigned input");
+			return false;
+		}
 
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
 }
 
+/**
+ * @brief Median over the valid (non-zero) pixels of the window around every valid pixel, invalid pixels stay zero.
+ *
+ * Uses Huang's sliding histogram. The window walks the image in a snake pattern, so every step only adds and
+ * removes one row or column of the window. The median is tracked incrementally together with the number of
+ * values below it, when it has to move, empty blocks of 256 values are skipped using the coarse histogram.
+ */
+void filter::median_filter::median_16u(const cv::Mat& input, cv::Mat& output) const
+{
+	const int rows = input.rows;
+	const int cols = input.cols;
+	const int r = size.value() / 2;
+
+	fine.assign(value_count, 0);
+	coarse.assign(value_count / block_size, 0);
+
+	int count = 0;
+	int median = 0;
+	int below = 0;
+
+	const auto add = [&](const uint16_t value)
+		{
+			if (value == 0)
+				return;
+			++fine[value];
+			++coarse[value / block_size];
+			++count;
+			below += value < median;
+		};
+
+	const auto remove = [&](const uint16_t value)
+		{
+			if (value == 0)
+				return;
+			--fine[value];
+			--coarse[value / block_size];
+			--count;
+			below -= value < median;
+		};
+
+	// apply 'update' to row 'y' between columns 'x0' and 'x1' (inclusive), clipped to the image
+	const auto update_row = [&](const int y, const int x0, const int x1, const auto& update)
+		{
+			if (y < 0 || y >= rows)
+				return;
+			const uint16_t* row = input.ptr<uint16_t>(y);
+			for (int x = std::max(x0, 0); x <= std::min(x1, cols - 1); ++x)
+				update(row[x]);
+		};
+
+	const auto update_column = [&](const int x, const int y0, const int y1, const auto& update)
+		{
+			if (x < 0 || x >= cols)
+				return;
+			for (int y = std::max(y0, 0); y <= std::min(y1, rows - 1); ++y)
+				update(input.ptr<uint16_t>(y)[x]);
+		};
+
+	// only called with at least one value in the window
+	const auto find_median = [&]()
+		{
+			const int target = (count - 1) / 2;
+			while (below > target)
+			{
+				--median;
+				while ((median % block_size) == block_size - 1 && coarse[median / block_size] == 0)
+					median -= block_size;
+				below -= fine[median];
+			}
+			while (below + fine[median] <= target)
+			{
+				below += fine[median];
+				++median;
+				while ((median % block_size) == 0 && coarse[median / block_size] == 0)
+					median += block_size;
+			}
+			return static_cast<uint16_t>(median);
+		};
+
+	// 'input' is read until the last pixel, so filtering in place goes through 'scratch'
+	const bool in_place = output.data == input.data;
+	if (in_place)
+		scratch.resize(input.total());
+	else
+		output.create(rows, cols, CV_16UC1);
+	cv::Mat result = in_place ? cv::Mat(rows, cols, CV_16UC1, scratch.data()) : output;
+
+	for (int y = 0; y <= r; ++y)
+		update_row(y, -r, r, add);
+
+	for (int y = 0; y < rows; ++y)
+	{
+		const bool forward = y % 2 == 0;
+		int x = forward ? 0 : cols - 1;
+		if (y > 0)
+		{
+			update_row(y - r - 1, x - r, x + r, remove);
+			update_row(y + r, x - r, x + r, add);
+		}
+
+		const uint16_t* in_row = input.ptr<uint16_t>(y);
+		uint16_t* out_row = result.ptr<uint16_t>(y);
+		while (true)
+		{
+			out_row[x] = in_row[x] != 0 ? find_median() : 0;
+
+			if (forward)
+			{
+				if (x == cols - 1)
+					break;
+				update_column(x - r, y - r, y + r, remove);
+				update_column(x + r + 1, y - r, y + r, add);
+				++x;
+			}
+			else
+			{
+				if (x == 0)
+					break;
+				update_column(x + r, y - r, y + r, remove);
+				update_column(x - r - 1, y - r, y + r, add);
+				--x;
+			}
+		}
+	}
+
+	if (in_place)
+		result.copyTo(output);
+}
+
 const bool filter::median_filter::load_json(const nlohmann::json& filter)
 {
 	try
@@ -0,0 +1,174 @@
+#include "common/filters/morphology_filter.h"
+
+#include <algorithm>
+
+#include "common/run_length.h"
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	/**
+	 * @brief Largest valid depth in the window around (x, y), used for pixels a dilation turns valid.
+	 * Taking the farthest neighbour grows the background into holes instead of fattening foreground objects.
+	 */
+	uint16_t window_max(const cv::Mat& depth, const int x, const int y, const int radius)
+	{
+		uint16_t max = 0;
+		for (int j = std::max(y - radius, 0); j <= std::min(y + radius, depth.rows - 1); ++j)
+		{
+			const uint16_t* row = depth.ptr<uint16_t>(j);
+			for (int i = std::max(x - radius, 0); i <= std::min(x + radius, depth.cols - 1); ++i)
+				max = std::max(max, row[i]);
+		}
+		return max;
+	}
+}
+
+filter::morphology_filter::morphology_filter(const morphology_operation operation)
+	: operation(operation), size(3)
+{
+}
+
+filter::morphology_filter::~morphology_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::morphology_filter::clone() const
+{
+	return std::make_unique<filter::morphology_filter>(*this);
+}
+
+const std::string filter::morphology_filter::type() const
+{
+	switch (operation)
+	{
+	case morphology_operation::dilate:
+		return "dilate-filter";
+	case morphology_operation::open:
+		return "open-filter";
+	case morphology_operation::close:
+		return "close-filter";
+	case morphology_operation::erode:
+	default:
+		return "erode-filter";
+	}
+}
+
+/**
+ * @brief Applies the operation to the valid pixel mask. Pixels that stay valid keep their depth, pixels
+ * that become valid get the largest depth in their window.
+ */
+const bool filter::morphology_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		const int radius = size.value() / 2;
+		const rle::run_mask mask = rle::encode(input);
+
+		rle::run_mask result;
+		switch (operation)
+		{
+		case morphology_operation::erode:
+			result = rle::erode(mask, radius);
+			break;
+		case morphology_operation::dilate:
+			result = rle::dilate(mask, radius);
+			break;
+		case morphology_operation::open:
+			result = rle::dilate(rle::erode(mask, radius), radius);
+			break;
+		case morphology_operation::close:
+			result = rle::erode(rle::dilate(mask, radius), radius);
+			break;
+		}
+
+		// pixels that become valid read their neighbours, so filtering in place goes through 'scratch'
+		const bool in_place = output.data == input.data;
+		if (in_place)
+		{
+			scratch.assign(input.total(), 0);
+		}
+		else
+		{
+			output.create(input.size(), CV_16UC1);
+			output.setTo(0);
+		}
+		cv::Mat filtered = in_place ? cv::Mat(input.size(), CV_16UC1, scratch.data()) : output;
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			uint16_t* out_row = filtered.ptr<uint16_t>(y);
+			for (const rle::run& r : result.rows[y])
+			{
+				for (int x = r.start; x < r.end; ++x)
+					out_row[x] = in_row[x] != 0 ? in_row[x] : window_max(input, x, y, radius);
+			}
+		}
+		if (in_place)
+			filtered.copyTo(output);
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::morphology_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		size = parameters["kernel-size"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::morphology_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"kernel-size", size.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -17,20 +17,20 @@ std::unique_ptr<filter::filter_base> filter::moving_average_filter::clone() cons
 	return std::make_unique<filter::moving_average_filter>(*this);
 }
 
-const bool filter::moving_average_filter::apply(cv::Mat& mat) const
+const bool filter::moving_average_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
 		// add to buffer
-		buffer.push_back(mat.clone());
+		buffer.push_back(input.clone());
 		while (buffer.size() > buffer_size.value())
 			buffer.pop_front();
 
 		for (const cv::Mat& curr_mat : buffer)
-			if (curr_mat.type() != mat.type() || curr_mat.size() != mat.size())
+			if (curr_mat.type() != input.type() || curr_mat.size() != input.size())
 				return false;
 
 		// average
@@ -49,22 +49,29 @@ const bool filter::moving_average_filter::apply(cv::Mat& mat) const
 
 		const cv::Mat mean_mat = accum_mat / num_mats;
 
-		cv::Mat output;
 		mean_mat.convertTo(output, CV_16U);
 
-		mat = output;
-
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
 }
 
+void filter::moving_average_filter::adopt_state(const filter_base& previous)
+{
+	const moving_average_filter* other = dynamic_cast<const moving_average_filter*>(&previous);
+	if (!other)
+		return;
+
+	buffer = other->buffer;
+	while (buffer.size() > buffer_size.value())
+		buffer.pop_front();
+}
+
 const bool filter::moving_average_filter::load_json(const nlohmann::json& filter)
 {
 	try
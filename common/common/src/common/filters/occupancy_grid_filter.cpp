@@ -0,0 +1,171 @@
+#include "common/filters/occupancy_grid_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+filter::occupancy_grid_filter::occupancy_grid_filter()
+	: x_min(-2000.0), x_max(2000.0), y_min(-2000.0), y_max(2000.0), z_min(0.0), z_max(2000.0),
+	cells_x(32), cells_y(32), cells_z(1), min_count(3)
+{
+}
+
+filter::occupancy_grid_filter::~occupancy_grid_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::occupancy_grid_filter::clone() const
+{
+	return std::make_unique<filter::occupancy_grid_filter>(*this);
+}
+
+const bool filter::occupancy_grid_filter::output_size(const cv::Size& input, cv::Size& output) const
+{
+	output = cv::Size(cells_x.value(), cells_y.value() * cells_z.value());
+	return true;
+}
+
+const bool filter::occupancy_grid_filter::uses_point_cloud() const
+{
+	return true;
+}
+
+const bool filter::occupancy_grid_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("needs the camera parameters of the input image");
+	return false;
+}
+
+/**
+ * @brief Counts the points of the valid pixels per cell in a single pass. Points outside the box and
+ * invalid (NaN) points fail the range checks and are not counted.
+ */
+const bool filter::occupancy_grid_filter::apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		const int nx = cells_x.value();
+		const int ny = cells_y.value();
+		const int nz = cells_z.value();
+
+		// cells per millimetre, an empty box puts every point outside
+		const auto scale = [](const int cells, const double min, const double max) {
+			return max > min ? static_cast<float>(cells / (max - min)) : 0.0f;
+		};
+		const float sx = scale(nx, x_min.value(), x_max.value());
+		const float sy = scale(ny, y_min.value(), y_max.value());
+		const float sz = scale(nz, z_min.value(), z_max.value());
+		const float x0 = static_cast<float>(x_min.value());
+		const float y0 = static_cast<float>(y_min.value());
+		const float z0 = static_cast<float>(z_min.value());
+
+		counts.assign(static_cast<size_t>(nx) * ny * nz, 0);
+		for (int y = 0; y < input.rows; ++y)
+		{
+			// pixels zeroed by an earlier point cloud filter still have their point
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const size_t first = static_cast<size_t>(y) * input.cols;
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const size_t i = first + x;
+				const float cx = (points.x[i] - x0) * sx;
+				const float cy = (points.y[i] - y0) * sy;
+				const float cz = (points.z[i] - z0) * sz;
+				if (in_row[x] == 0 || !(cx >= 0.0f && cx < nx && cy >= 0.0f && cy < ny && cz >= 0.0f && cz < nz))
+					continue;
+
+				++counts[(static_cast<size_t>(cz) * ny + static_cast<size_t>(cy)) * nx + static_cast<size_t>(cx)];
+			}
+		}
+
+		output.create(ny * nz, nx, CV_16UC1);
+		const uint32_t min = static_cast<uint32_t>(min_count.value());
+		for (int y = 0; y < output.rows; ++y)
+		{
+			const uint32_t* count_row = &counts[static_cast<size_t>(y) * nx];
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			for (int x = 0; x < nx; ++x)
+				out_row[x] = count_row[x] < min ? 0 : static_cast<uint16_t>(std::min<uint32_t>(count_row[x], UINT16_MAX));
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::occupancy_grid_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		x_min = parameters["x"]["min"].get<double>();
+		x_max = parameters["x"]["max"].get<double>();
+		y_min = parameters["y"]["min"].get<double>();
+		y_max = parameters["y"]["max"].get<double>();
+		z_min = parameters["z"]["min"].get<double>();
+		z_max = parameters["z"]["max"].get<double>();
+		cells_x = parameters["cells"]["x"].get<int>();
+		cells_y = parameters["cells"]["y"].get<int>();
+		cells_z = parameters["cells"]["z"].get<int>();
+		min_count = parameters["min-count"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::occupancy_grid_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"x", {{"min", x_min.value()}, {"max", x_max.value()}}},
+				{"y", {{"min", y_min.value()}, {"max", y_max.value()}}},
+				{"z", {{"min", z_min.value()}, {"max", z_max.value()}}},
+				{"cells", {
+					{"x", cells_x.value()},
+					{"y", cells_y.value()},
+					{"z", cells_z.value()},
+				}},
+				{"min-count", min_count.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,128 @@
+#include "common/filters/range_gate_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+filter::range_gate_filter::range_gate_filter()
+	: upper(10000.0), lower(0.0)
+{
+}
+
+filter::range_gate_filter::~range_gate_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::range_gate_filter::clone() const
+{
+	return std::make_unique<filter::range_gate_filter>(*this);
+}
+
+const std::string filter::range_gate_filter::type() const
+{
+	return "range-gate-filter";
+}
+
+const bool filter::range_gate_filter::uses_scan() const
+{
+	return true;
+}
+
+const bool filter::range_gate_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("works on polar scans and point lists only");
+	return false;
+}
+
+const bool filter::range_gate_filter::apply_to_scan(const frame::Scan& input, frame::Scan& output) const
+{
+	const float low = static_cast<float>(lower.value());
+	const float high = static_cast<float>(upper.value());
+
+	output.kind = input.kind;
+	output.start_angle = input.start_angle;
+	output.angular_resolution = input.angular_resolution;
+	output.confidence = input.confidence;
+
+	if (input.kind == frame::kind::cartesian)
+	{
+		// squared distances, so no square root per point
+		const float low2 = low * low;
+		const float high2 = high * high;
+
+		output.distance.clear();
+		output.points.clear();
+		std::copy_if(input.points.begin(), input.points.end(), std::back_inserter(output.points), [low2, high2](const visionary::PointXYZC& point)
+			{
+				const float distance2 = point.x * point.x + point.y * point.y + point.z * point.z;
+				return distance2 >= low2 && distance2 <= high2;
+			});
+
+		return true;
+	}
+
+	output.points.clear();
+	output.distance.resize(input.distance.size());
+	for (size_t i = 0; i < input.distance.size(); ++i)
+	{
+		const float distance = input.distance[i];
+		output.distance[i] = distance >= low && distance <= high ? distance : 0.0f;
+	}
+
+	return true;
+}
+
+const bool filter::range_gate_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		upper = parameters["upper"].get<double>();
+		lower = parameters["lower"].get<double>();
+
+		if (upper.value() < lower.value())
+		{
+			const auto upper_temp = upper;
+			upper = lower.value();
+			lower = upper_temp.value();
+		}
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::range_gate_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"upper", upper.value()},
+				{"lower", lower.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -1,5 +1,7 @@
 #include "common/filters/resize_filter.h"
 
+#include <algorithm>
+
 #include "opencv2/imgproc.hpp"
 
 #include "spdlog/spdlog.h"
@@ -8,6 +10,12 @@ filter::resize_filter::resize_filter()
 {
 }
 
+filter::resize_filter::resize_filter(const int width, const int height)
+{
+	size_x = width;
+	size_y = height;
+}
+
 filter::resize_filter::~resize_filter()
 {
 }
@@ -17,28 +25,124 @@ std::unique_ptr<filter::filter_base> filter::resize_filter::clone() const
 	return std::make_unique<resize_filter>(*this);
 }
 
-const bool filter::resize_filter::apply(cv::Mat& mat) const
+const bool filter::resize_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
-		cv::resize(mat, output, cv::Size(size_x.value(), size_y.value()), 0.0f, 0.0f, cv::InterpolationFlags::INTER_AREA);
+		if (input.cols == size_x.value() && input.rows == size_y.value())
+			input.copyTo(output);
+		else if (input.type() != CV_16UC1)
+			cv::resize(input, output, cv::Size(size_x.value(), size_y.value()), 0.0f, 0.0f, cv::InterpolationFlags::INTER_AREA);
+		else if (input.cols % size_x.value() == 0 && input.rows % size_y.value() == 0)
+			downsample_integer(input, output, size_x.value(), size_y.value());
+		else
+			resize_valid(input, output, size_x.value(), size_y.value());
 
-		mat = output;
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
 }
 
+const bool filter::resize_filter::output_size(const cv::Size& input, cv::Size& output) const
+{
+	output = cv::Size(size_x.value(), size_y.value());
+	return !input.empty();
+}
+
+/**
+ * @brief Area downsampling by an integer factor in each direction. Invalid pixels (zero, and 0xFFFF for
+ * saturated ones) are left out of the average, a block without any valid pixel stays zero.
+ *
+ * @param input CV_16UC1 image with dimensions divisible by 'width' and 'height'
+ * @param output Downsampled image
+ * @param width Output width
+ * @param height Output height
+ */
+void filter::resize_filter::downsample_integer(const cv::Mat& input, cv::Mat& output, const int width, const int height)
+{
+	assert(input.type() == CV_16UC1 && input.cols % width == 0 && input.rows % height == 0);
+
+	const int factor_x = input.cols / width;
+	const int factor_y = input.rows / height;
+
+	output.create(height, width, CV_16UC1);
+	// a block of a full resolution image resized to 1x1 holds far more than the 65537 pixels of 0xFFFF a 32 bit sum fits
+	std::vector<uint64_t> sums(width);
+	std::vector<uint32_t> counts(width);
+
+	for (int out_y = 0; out_y < height; ++out_y)
+	{
+		std::fill(sums.begin(), sums.end(), 0);
+		std::fill(counts.begin(), counts.end(), 0);
+
+		for (int y = out_y * factor_y; y < (out_y + 1) * factor_y; ++y)
+		{
+			const uint16_t* row = input.ptr<uint16_t>(y);
+			for (int out_x = 0; out_x < width; ++out_x)
+			{
+				uint64_t sum = 0;
+				uint32_t count = 0;
+				for (int k = 0; k < factor_x; ++k)
+				{
+					const uint16_t value = row[k];
+					const bool valid = value != 0 && value != 0xFFFF;
+					sum += valid ? value : 0;
+					count += valid;
+				}
+				sums[out_x] += sum;
+				counts[out_x] += count;
+				row += factor_x;
+			}
+		}
+
+		uint16_t* out_row = output.ptr<uint16_t>(out_y);
+		for (int out_x = 0; out_x < width; ++out_x)
+		{
+			const uint32_t count = counts[out_x];
+			out_row[out_x] = count == 0 ? 0 : static_cast<uint16_t>((sums[out_x] + count / 2) / count);
+		}
+	}
+}
+
+/**
+ * @brief Area resize to an arbitrary size with the same invalid pixel handling as 'downsample_integer'.
+ *
+ * Values and a validity mask are resized separately, dividing one by the other gives the mean of the
+ * valid pixels covered by each output pixel.
+ *
+ * @param input CV_16UC1 image
+ * @param output Resized image
+ * @param width Output width
+ * @param height Output height
+ */
+void filter::resize_filter::resize_valid(const cv::Mat& input, cv::Mat& output, const int width, const int height)
+{
+	const cv::Size size(width, height);
+
+	const cv::Mat invalid = (input == 0) | (input == 0xFFFF);
+
+	cv::Mat values, weights;
+	input.convertTo(values, CV_32F);
+	values.setTo(0.0, invalid);
+	invalid.convertTo(weights, CV_32F, -1.0 / 255.0, 1.0);
+
+	cv::resize(values, values, size, 0.0, 0.0, cv::InterpolationFlags::INTER_AREA);
+	cv::resize(weights, weights, size, 0.0, 0.0, cv::InterpolationFlags::INTER_AREA);
+
+	cv::Mat mean;
+	cv::divide(values, weights, mean);
+	mean.setTo(0.0, weights < 1e-6);
+	mean.convertTo(output, CV_16U);
+}
+
 const bool filter::resize_filter::load_json(const nlohmann::json& filter)
 {
 	try
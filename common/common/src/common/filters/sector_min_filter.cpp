@@ -0,0 +1,155 @@
+#include "common/filters/sector_min_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	constexpr double pi = 3.14159265358979323846;
+}
+
+filter::sector_min_filter::sector_min_filter()
+	: sectors(8), angle_min(-90.0), angle_max(90.0)
+{
+}
+
+filter::sector_min_filter::~sector_min_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::sector_min_filter::clone() const
+{
+	return std::make_unique<filter::sector_min_filter>(*this);
+}
+
+const std::string filter::sector_min_filter::type() const
+{
+	return "sector-min-filter";
+}
+
+const bool filter::sector_min_filter::uses_scan() const
+{
+	return true;
+}
+
+const bool filter::sector_min_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("works on polar scans and point lists only");
+	return false;
+}
+
+const bool filter::sector_min_filter::apply_to_scan(const frame::Scan& input, frame::Scan& output) const
+{
+	const int num_sectors = sectors.value();
+	constexpr float none = std::numeric_limits<float>::max();
+
+	output.kind = frame::kind::polar;
+	output.confidence.clear();
+	output.points.clear();
+	output.distance.assign(num_sectors, none);
+
+	if (input.kind == frame::kind::cartesian)
+	{
+		const double width = angle_max.value() - angle_min.value();
+		if (width <= 0.0)
+		{
+			log_apply_error("angle.max must be larger than angle.min");
+			return false;
+		}
+
+		const double sectors_per_rad = num_sectors / (width * pi / 180.0);
+		const double first = angle_min.value() * pi / 180.0;
+		for (const visionary::PointXYZC& point : input.points)
+		{
+			const double position = (std::atan2(static_cast<double>(point.y), static_cast<double>(point.x)) - first) * sectors_per_rad;
+			if (position < 0.0 || position > num_sectors)
+				continue;
+
+			const int sector = std::min(static_cast<int>(position), num_sectors - 1);
+			const float distance = std::sqrt(point.x * point.x + point.y * point.y + point.z * point.z);
+			output.distance[sector] = std::min(output.distance[sector], distance);
+		}
+
+		output.angular_resolution = static_cast<float>(width * pi / 180.0 / num_sectors);
+		output.start_angle = static_cast<float>(first) + output.angular_resolution / 2.0f;
+	}
+	else
+	{
+		// sector borders spread evenly, like the cells of the cell filters
+		const int rays = static_cast<int>(input.distance.size());
+		for (int i = 0; i < rays; ++i)
+		{
+			const float distance = input.distance[i];
+			const int sector = static_cast<int>(static_cast<int64_t>(i) * num_sectors / rays);
+			if (distance > 0.0f)
+				output.distance[sector] = std::min(output.distance[sector], distance);
+		}
+
+		const float rays_per_sector = static_cast<float>(rays) / static_cast<float>(num_sectors);
+		output.angular_resolution = input.angular_resolution * rays_per_sector;
+		output.start_angle = input.start_angle + input.angular_resolution * (rays_per_sector - 1.0f) / 2.0f;
+	}
+
+	for (float& distance : output.distance)
+	{
+		if (distance == none)
+			distance = 0.0f;
+	}
+
+	return true;
+}
+
+const bool filter::sector_min_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		sectors = parameters["sectors"].get<int>();
+		angle_min = parameters["angle"]["min"].get<double>();
+		angle_max = parameters["angle"]["max"].get<double>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::sector_min_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"sectors", sectors.value()},
+				{"angle", {
+					{"min", angle_min.value()},
+					{"max", angle_max.value()},
+				}},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,135 @@
+#include "common/filters/temporal_hole_fill_filter.h"
+
+#include "spdlog/spdlog.h"
+
+filter::temporal_hole_fill_filter::temporal_hole_fill_filter()
+{
+}
+
+filter::temporal_hole_fill_filter::~temporal_hole_fill_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::temporal_hole_fill_filter::clone() const
+{
+	return std::make_unique<filter::temporal_hole_fill_filter>(*this);
+}
+
+/**
+ * @brief Replaces invalid (zero) pixels with the last valid value of that pixel, for at most 'max-age'
+ * consecutive frames.
+ */
+const bool filter::temporal_hole_fill_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		if (input.size() != size)
+		{
+			size = input.size();
+			last_valid.assign(static_cast<size_t>(size.area()), 0);
+			age.assign(static_cast<size_t>(size.area()), 0);
+		}
+
+		output.create(input.size(), CV_16UC1);
+
+		const uint16_t limit = static_cast<uint16_t>(max_age.value());
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			uint16_t* last_row = &last_valid[static_cast<size_t>(y) * input.cols];
+			uint16_t* age_row = &age[static_cast<size_t>(y) * input.cols];
+
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const uint16_t value = in_row[x];
+				if (value != 0)
+				{
+					last_row[x] = value;
+					age_row[x] = 0;
+					out_row[x] = value;
+				}
+				else
+				{
+					// age stops one past the limit so it never wraps around
+					age_row[x] += age_row[x] <= limit;
+					out_row[x] = age_row[x] <= limit ? last_row[x] : 0;
+				}
+			}
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+void filter::temporal_hole_fill_filter::adopt_state(const filter_base& previous)
+{
+	const temporal_hole_fill_filter* other = dynamic_cast<const temporal_hole_fill_filter*>(&previous);
+	if (!other)
+		return;
+
+	last_valid = other->last_valid;
+	age = other->age;
+	size = other->size;
+}
+
+const bool filter::temporal_hole_fill_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		max_age = parameters["max-age"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::temporal_hole_fill_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"max-age", max_age.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
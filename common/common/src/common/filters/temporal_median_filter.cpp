@@ -0,0 +1,199 @@
+#include "common/filters/temporal_median_filter.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+filter::temporal_median_filter::temporal_median_filter()
+	: window(0), head(0), filled(0)
+{
+}
+
+filter::temporal_median_filter::~temporal_median_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::temporal_median_filter::clone() const
+{
+	return std::make_unique<filter::temporal_median_filter>(*this);
+}
+
+/**
+ * @brief Per pixel median of the valid values in the last 'window-size' frames.
+ *
+ * Every pixel keeps its window sorted. A new frame replaces the oldest value of each window and moves
+ * it to its sorted position, which costs a few comparisons per pixel instead of sorting the window.
+ */
+const bool filter::temporal_median_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		if (input.size() != size || window != window_size.value())
+			reset(input.size());
+
+		output.create(input.size(), CV_16UC1);
+
+		const int n = window;
+		const bool full = filled == n;
+		const int count = full ? n : filled + 1;
+
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			const size_t row_offset = static_cast<size_t>(y) * input.cols;
+
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const size_t p = row_offset + x;
+				uint16_t* s = &sorted[p * n];
+				uint16_t& slot = history[p * n + head];
+				const uint16_t value = in_row[x];
+
+				int i;
+				if (full)
+				{
+					// overwrite the oldest value in place, then bubble it to its sorted position
+					const uint16_t old = slot;
+					invalid[p] -= old == 0;
+					i = static_cast<int>(std::lower_bound(s, s + n, old) - s);
+					if (value > old)
+					{
+						while (i + 1 < n && s[i + 1] < value)
+						{
+							s[i] = s[i + 1];
+							++i;
+						}
+					}
+					else
+					{
+						while (i > 0 && s[i - 1] > value)
+						{
+							s[i] = s[i - 1];
+							--i;
+						}
+					}
+				}
+				else
+				{
+					// window still filling, insertion sort step
+					i = filled;
+					while (i > 0 && s[i - 1] > value)
+					{
+						s[i] = s[i - 1];
+						--i;
+					}
+				}
+				s[i] = value;
+				slot = value;
+				invalid[p] += value == 0;
+
+				const int first = invalid[p];
+				const int valid = count - first;
+				if (valid == 0)
+				{
+					out_row[x] = 0;
+				}
+				else
+				{
+					const uint16_t* v = s + first;
+					out_row[x] = (valid & 1) ? v[valid / 2] : static_cast<uint16_t>((v[valid / 2 - 1] + v[valid / 2] + 1) / 2);
+				}
+			}
+		}
+
+		head = (head + 1) % n;
+		filled = count;
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+void filter::temporal_median_filter::reset(const cv::Size& new_size) const
+{
+	size = new_size;
+	window = window_size.value();
+	head = 0;
+	filled = 0;
+
+	const size_t num_pixels = static_cast<size_t>(size.area());
+	history.assign(num_pixels * window, 0);
+	sorted.assign(num_pixels * window, 0);
+	invalid.assign(num_pixels, 0);
+}
+
+void filter::temporal_median_filter::adopt_state(const filter_base& previous)
+{
+	const temporal_median_filter* other = dynamic_cast<const temporal_median_filter*>(&previous);
+	if (!other || other->window != window_size.value())
+		return;
+
+	history = other->history;
+	sorted = other->sorted;
+	invalid = other->invalid;
+	size = other->size;
+	window = other->window;
+	head = other->head;
+	filled = other->filled;
+}
+
+const bool filter::temporal_median_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		window_size = parameters["window-size"].get<int>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::temporal_median_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"window-size", window_size.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -18,26 +18,21 @@ std::unique_ptr<filter::filter_base> filter::threshold_filter::clone() const
 	return std::make_unique<filter::threshold_filter>(*this);
 }
 
-const bool filter::threshold_filter::apply(cv::Mat& mat) const
+const bool filter::threshold_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
 {
 	try
 	{
-		if (mat.empty())
+		if (input.empty())
 			return false;
 
-		cv::Mat output;
-		cv::threshold(mat, output, upper.value(), 0, cv::THRESH_TOZERO_INV);
-		mat = output;
-    
-		cv::threshold(mat, output, lower.value(), 0, cv::THRESH_TOZERO);
-		mat = output;
+		cv::threshold(input, output, upper.value(), 0, cv::THRESH_TOZERO_INV);
+		cv::threshold(output, output, lower.value(), 0, cv::THRESH_TOZERO);
 
 		return true;
 	}
 	catch (const cv::Exception& e)
 	{
-		spdlog::get("filter")->error("'{}' failed to apply with exception {}. Filter parameters:\n{}",
-			type(), e.what(), to_json()["parameters"].dump(2));
+		log_apply_error(e.what());
 
 		return false;
 	}
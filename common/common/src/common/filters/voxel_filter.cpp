@@ -0,0 +1,151 @@
+#include "common/filters/voxel_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	// voxel coordinates are packed into 21 bits per axis, enough for +-1 km at the smallest voxel size of 1 mm
+	constexpr int64_t voxel_bits = 21;
+	constexpr int64_t voxel_offset = int64_t(1) << (voxel_bits - 1);
+	constexpr int64_t voxel_mask = (int64_t(1) << voxel_bits) - 1;
+
+	inline uint64_t voxel_key(const float x, const float y, const float z, const float inverse_size)
+	{
+		const auto axis = [&](const float value) {
+			const int64_t cell = static_cast<int64_t>(std::floor(value * inverse_size)) + voxel_offset;
+			return static_cast<uint64_t>(std::clamp<int64_t>(cell, 0, voxel_mask));
+		};
+		return (axis(x) << (2 * voxel_bits)) | (axis(y) << voxel_bits) | axis(z);
+	}
+}
+
+filter::voxel_filter::voxel_filter()
+	: size(50.0)
+{
+}
+
+filter::voxel_filter::~voxel_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::voxel_filter::clone() const
+{
+	return std::make_unique<filter::voxel_filter>(*this);
+}
+
+const bool filter::voxel_filter::uses_point_cloud() const
+{
+	return true;
+}
+
+const bool filter::voxel_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("needs the camera parameters of the input image");
+	return false;
+}
+
+/**
+ * @brief Sorts the valid pixels by voxel and then depth, and keeps the first pixel of every voxel.
+ */
+const bool filter::voxel_filter::apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		const float inverse_size = static_cast<float>(1.0 / size.value());
+
+		pixels.clear();
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			const uint32_t first = static_cast<uint32_t>(y) * input.cols;
+			for (int x = 0; x < input.cols; ++x)
+			{
+				// invalid pixels have no point, pixels zeroed by an earlier point cloud filter still have theirs
+				const uint32_t i = first + x;
+				if (in_row[x] != 0 && !std::isnan(points.x[i]))
+					pixels.push_back({ voxel_key(points.x[i], points.y[i], points.z[i], inverse_size), in_row[x], i });
+			}
+		}
+
+		std::sort(pixels.begin(), pixels.end(), [](const voxel_pixel& a, const voxel_pixel& b) {
+			return a.voxel < b.voxel || (a.voxel == b.voxel && a.depth < b.depth);
+		});
+
+		output.create(input.size(), CV_16UC1);
+		output.setTo(0);
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			if (i > 0 && pixels[i].voxel == pixels[i - 1].voxel)
+				continue;
+
+			const voxel_pixel& kept = pixels[i];
+			output.ptr<uint16_t>(kept.index / input.cols)[kept.index % input.cols] = kept.depth;
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::voxel_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		size = parameters["voxel-size"].get<double>();
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::voxel_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", {
+				{"voxel-size", size.value()},
+			}}
+		};
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
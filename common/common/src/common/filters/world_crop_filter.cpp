@@ -0,0 +1,153 @@
+#include "common/filters/world_crop_filter.h"
+
+#include "spdlog/spdlog.h"
+
+filter::world_crop_filter::world_crop_filter(const world_crop_region region)
+	: region(region), z_min(0.0), z_max(3000.0)
+{
+	// the height variant does not limit x and y
+	const double extent = region == world_crop_region::box ? 1000.0 : 100000.0;
+	x_min = -extent;
+	x_max = extent;
+	y_min = -extent;
+	y_max = extent;
+}
+
+filter::world_crop_filter::~world_crop_filter()
+{
+}
+
+std::unique_ptr<filter::filter_base> filter::world_crop_filter::clone() const
+{
+	return std::make_unique<filter::world_crop_filter>(*this);
+}
+
+const std::string filter::world_crop_filter::type() const
+{
+	return region == world_crop_region::height ? "height-filter" : "world-box-filter";
+}
+
+const bool filter::world_crop_filter::uses_point_cloud() const
+{
+	return true;
+}
+
+const bool filter::world_crop_filter::apply_to(const cv::Mat& input, cv::Mat& output) const
+{
+	log_apply_error("needs the camera parameters of the input image");
+	return false;
+}
+
+/**
+ * @brief Zeros every pixel whose point lies outside the box. Invalid points are NaN and fail every
+ * comparison, so they stay zero.
+ */
+const bool filter::world_crop_filter::apply_to_cloud(const cv::Mat& input, const cloud::point_cloud& points, cv::Mat& output) const
+{
+	try
+	{
+		if (input.empty())
+			return false;
+
+		if (input.type() != CV_16UC1)
+		{
+			log_apply_error("input must be CV_16UC1");
+			return false;
+		}
+
+		const float x0 = static_cast<float>(x_min.value()), x1 = static_cast<float>(x_max.value());
+		const float y0 = static_cast<float>(y_min.value()), y1 = static_cast<float>(y_max.value());
+		const float z0 = static_cast<float>(z_min.value()), z1 = static_cast<float>(z_max.value());
+
+		output.create(input.size(), CV_16UC1);
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const size_t first = static_cast<size_t>(y) * input.cols;
+			const float* px = &points.x[first];
+			const float* py = &points.y[first];
+			const float* pz = &points.z[first];
+			const uint16_t* in_row = input.ptr<uint16_t>(y);
+			uint16_t* out_row = output.ptr<uint16_t>(y);
+			for (int x = 0; x < input.cols; ++x)
+			{
+				const bool inside = px[x] >= x0 && px[x] <= x1 && py[x] >= y0 && py[x] <= y1 && pz[x] >= z0 && pz[x] <= z1;
+				out_row[x] = inside ? in_row[x] : 0;
+			}
+		}
+
+		return true;
+	}
+	catch (const cv::Exception& e)
+	{
+		log_apply_error(e.what());
+
+		return false;
+	}
+}
+
+const bool filter::world_crop_filter::load_json(const nlohmann::json& filter)
+{
+	try
+	{
+		nlohmann::json parameters = filter["parameters"];
+		if (region == world_crop_region::box)
+		{
+			x_min = parameters["x"]["min"].get<double>();
+			x_max = parameters["x"]["max"].get<double>();
+			y_min = parameters["y"]["min"].get<double>();
+			y_max = parameters["y"]["max"].get<double>();
+			z_min = parameters["z"]["min"].get<double>();
+			z_max = parameters["z"]["max"].get<double>();
+		}
+		else
+		{
+			z_min = parameters["height"]["min"].get<double>();
+			z_max = parameters["height"]["max"].get<double>();
+		}
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load '{}' filter from json: {}", type(), e.what());
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to load '{}' filter from json", type());
+		return false;
+	}
+
+	return true;
+}
+
+const nlohmann::json filter::world_crop_filter::to_json() const
+{
+	try
+	{
+		nlohmann::json j = {
+			{"type", type()},
+			{"parameters", nlohmann::json::object()}
+		};
+		if (region == world_crop_region::box)
+		{
+			j["parameters"]["x"] = { {"min", x_min.value()}, {"max", x_max.value()} };
+			j["parameters"]["y"] = { {"min", y_min.value()}, {"max", y_max.value()} };
+			j["parameters"]["z"] = { {"min", z_min.value()}, {"max", z_max.value()} };
+		}
+		else
+		{
+			j["parameters"]["height"] = { {"min", z_min.value()}, {"max", z_max.value()} };
+		}
+
+		return j;
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to convert '{}' filter to json: {}", type(), e.what());
+		return nlohmann::json{};
+	}
+	catch (...)
+	{
+		spdlog::error("Failed to convert '{}' filter to json", type());
+		return nlohmann::json{};
+	}
+}
@@ -0,0 +1,233 @@
+#include "common/fixed_point_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	constexpr int max_kernel_size = 7;
+
+	// integer weights of one pass, only the first 'size' entries are used
+	struct kernel_1d
+	{
+		int size;
+		std::array<uint32_t, max_kernel_size> weights;
+		uint32_t sum;
+	};
+
+	// scratch buffers reused between calls, one set per thread so filters in different pipelines do not share them
+	thread_local std::vector<uint16_t> padded_row;
+	thread_local std::vector<uint32_t> horizontal;
+
+	const bool supported(const int size)
+	{
+		return size == 1 || size == 3 || size == 5 || size == 7;
+	}
+
+	/**
+	 * @brief Index into a line of 'length' pixels reflected like BORDER_REFLECT_101 (dcb|abcd|cba). Only valid
+	 * for overhangs shorter than 'length'.
+	 */
+	inline int reflect_101(const int i, const int length)
+	{
+		if (i < 0)
+			return -i;
+		if (i >= length)
+			return 2 * length - 2 - i;
+		return i;
+	}
+
+	template<int K>
+	void horizontal_pass(const cv::Mat& input, const kernel_1d& kernel)
+	{
+		constexpr int r = K / 2;
+		const int cols = input.cols;
+		padded_row.resize(static_cast<size_t>(cols) + 2 * r);
+		horizontal.resize(static_cast<size_t>(cols) * input.rows);
+
+		for (int y = 0; y < input.rows; ++y)
+		{
+			const uint16_t* row = input.ptr<uint16_t>(y);
+			std::copy(row, row + cols, padded_row.begin() + r);
+			for (int i = 1; i <= r; ++i)
+			{
+				padded_row[r - i] = row[i];
+				padded_row[r + cols - 1 + i] = row[cols - 1 - i];
+			}
+
+			const uint16_t* src = padded_row.data();
+			uint32_t* dst = &horizontal[static_cast<size_t>(y) * cols];
+			for (int x = 0; x < cols; ++x)
+			{
+				uint32_t sum = 0;
+				for (int k = 0; k < K; ++k)
+					sum += kernel.weights[k] * src[x + k];
+				dst[x] = sum;
+			}
+		}
+	}
+
+	template<int K>
+	void vertical_pass(const int cols, const int rows, const kernel_1d& kernel, const uint32_t divisor, cv::Mat& output)
+	{
+		constexpr int r = K / 2;
+
+		// rounded division by multiplying with a 32 bit fixed point reciprocal. exact for power of two divisors
+		// (gaussian) and whenever sum * divisor fits in 32 bit (box and stack kernels up to 7x7)
+		const uint64_t reciprocal = ((uint64_t(1) << 32) + divisor - 1) / divisor;
+		const uint32_t half = divisor / 2;
+
+		for (int y = 0; y < rows; ++y)
+		{
+			std::array<const uint32_t*, K> src;
+			for (int k = 0; k < K; ++k)
+				src[k] = &horizontal[static_cast<size_t>(reflect_101(y - r + k, rows)) * cols];
+
+			uint16_t* dst = output.ptr<uint16_t>(y);
+			for (int x = 0; x < cols; ++x)
+			{
+				uint32_t sum = 0;
+				for (int k = 0; k < K; ++k)
+					sum += kernel.weights[k] * src[k][x];
+				dst[x] = static_cast<uint16_t>((static_cast<uint64_t>(sum + half) * reciprocal) >> 32);
+			}
+		}
+	}
+
+	const bool convolve(const cv::Mat& input, cv::Mat& output, const kernel_1d& kernel_x, const kernel_1d& kernel_y)
+	{
+		if (input.type() != CV_16UC1 || input.empty())
+			return false;
+		if (!supported(kernel_x.size) || !supported(kernel_y.size))
+			return false;
+		// reflecting needs more pixels than the kernel radius
+		if (input.cols <= kernel_x.size / 2 || input.rows <= kernel_y.size / 2)
+			return false;
+
+		const int cols = input.cols;
+		const int rows = input.rows;
+
+		switch (kernel_x.size)
+		{
+		case 1: horizontal_pass<1>(input, kernel_x); break;
+		case 3: horizontal_pass<3>(input, kernel_x); break;
+		case 5: horizontal_pass<5>(input, kernel_x); break;
+		case 7: horizontal_pass<7>(input, kernel_x); break;
+		}
+
+		// the input is fully consumed by now, so 'output' may share its data
+		output.create(rows, cols, CV_16UC1);
+
+		const uint32_t divisor = kernel_x.sum * kernel_y.sum;
+		switch (kernel_y.size)
+		{
+		case 1: vertical_pass<1>(cols, rows, kernel_y, divisor, output); break;
+		case 3: vertical_pass<3>(cols, rows, kernel_y, divisor, output); break;
+		case 5: vertical_pass<5>(cols, rows, kernel_y, divisor, output); break;
+		case 7: vertical_pass<7>(cols, rows, kernel_y, divisor, output); break;
+		}
+
+		return true;
+	}
+
+	const kernel_1d box_kernel(const int size)
+	{
+		kernel_1d kernel{ size, {}, static_cast<uint32_t>(size) };
+		std::fill(kernel.weights.begin(), kernel.weights.end(), 1);
+		return kernel;
+	}
+
+	/**
+	 * @brief Triangle kernel 1, 2, ..., r + 1, ..., 2, 1 which stack blur approximates a gaussian with.
+	 */
+	const kernel_1d stack_kernel(const int size)
+	{
+		const int r = size / 2;
+		kernel_1d kernel{ size, {}, static_cast<uint32_t>((r + 1) * (r + 1)) };
+		for (int i = 0; i < size && i < max_kernel_size; ++i)
+			kernel.weights[i] = static_cast<uint32_t>(r + 1 - std::abs(i - r));
+		return kernel;
+	}
+
+	/**
+	 * @brief Gaussian kernel with weights summing to 256. Uses OpenCV's fixed small kernels for 'sigma' <= 0,
+	 * otherwise samples the gaussian and puts the rounding error on the center weight.
+	 */
+	const kernel_1d gaussian_kernel(const int size, const double sigma)
+	{
+		kernel_1d kernel{ size, {}, 256 };
+		if (size == 1)
+		{
+			kernel.weights[0] = 1;
+			kernel.sum = 1;
+			return kernel;
+		}
+
+		if (sigma <= 0.0)
+		{
+			static constexpr uint32_t small_3[] = { 64, 128, 64 };
+			static constexpr uint32_t small_5[] = { 16, 64, 96, 64, 16 };
+			static constexpr uint32_t small_7[] = { 8, 28, 56, 72, 56, 28, 8 };
+			const uint32_t* small = size == 3 ? small_3 : size == 5 ? small_5 : small_7;
+			std::copy(small, small + size, kernel.weights.begin());
+			return kernel;
+		}
+
+		const int r = size / 2;
+		std::array<double, max_kernel_size> exact{};
+		double total = 0.0;
+		for (int i = 0; i < size; ++i)
+		{
+			exact[i] = std::exp(-((i - r) * (i - r)) / (2.0 * sigma * sigma));
+			total += exact[i];
+		}
+
+		int rounded = 0;
+		for (int i = 0; i < size; ++i)
+		{
+			kernel.weights[i] = static_cast<uint32_t>(std::lround(256.0 * exact[i] / total));
+			rounded += kernel.weights[i];
+		}
+		kernel.weights[r] += 256 - rounded;
+
+		return kernel;
+	}
+}
+
+/**
+ * @brief Integer version of 'cv::blur'.
+ */
+const bool kernels::box_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size)
+{
+	if (!supported(kernel_size.width) || !supported(kernel_size.height))
+		return false;
+
+	return convolve(input, output, box_kernel(kernel_size.width), box_kernel(kernel_size.height));
+}
+
+/**
+ * @brief Integer version of 'cv::GaussianBlur' with 8 bit weights per direction.
+ */
+const bool kernels::gaussian_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size, const double sigma_x, const double sigma_y)
+{
+	if (!supported(kernel_size.width) || !supported(kernel_size.height))
+		return false;
+
+	// same sigma rules as cv::GaussianBlur
+	const double sigma_y_used = sigma_y > 0.0 ? sigma_y : sigma_x;
+
+	return convolve(input, output, gaussian_kernel(kernel_size.width, sigma_x), gaussian_kernel(kernel_size.height, sigma_y_used));
+}
+
+/**
+ * @brief Integer version of 'cv::stackBlur'.
+ */
+const bool kernels::stack_blur(const cv::Mat& input, cv::Mat& output, const cv::Size& kernel_size)
+{
+	if (!supported(kernel_size.width) || !supported(kernel_size.height))
+		return false;
+
+	return convolve(input, output, stack_kernel(kernel_size.width), stack_kernel(kernel_size.height));
+}
@@ -1,9 +1,128 @@
 #include "common/frame.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    // buffers kept for reuse, enough for the frames in flight between the camera and the PLC
+    constexpr size_t max_free_buffers = 8;
+
+    constexpr uint32_t channel_bit(const frame::channel channel)
+    {
+        return 1u << static_cast<int>(channel);
+    }
+}
+
+const char* frame::channel_name(const channel channel)
+{
+    switch (channel)
+    {
+    case channel::distance: return "distance";
+    case channel::intensity: return "intensity";
+    case channel::state: return "state";
+    case channel::confidence: return "confidence";
+    }
+
+    return "unknown";
+}
+
+const bool frame::parse_kind(const std::string& name, kind& parsed)
+{
+    if (name == "image")
+        parsed = kind::image;
+    else if (name == "polar")
+        parsed = kind::polar;
+    else if (name == "cartesian")
+        parsed = kind::cartesian;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * @brief Number of rays of a polar scan or points of a point list.
+ */
+const size_t frame::Scan::size() const
+{
+    return kind == frame::kind::cartesian ? points.size() : distance.size();
+}
+
+frame::buffer_pool::buffer_pool()
+    : _free(std::make_shared<free_list>())
+{
+}
+
+/**
+ * @brief Returns a buffer of 'size' elements with unspecified content. It goes back to the pool when the
+ * last copy of the pointer is released.
+ */
+std::shared_ptr<std::vector<uint16_t>> frame::buffer_pool::acquire(const size_t size)
+{
+    std::unique_ptr<std::vector<uint16_t>> buffer;
+    {
+        std::lock_guard<std::mutex> locker(_free->mutex);
+        if (!_free->buffers.empty())
+        {
+            buffer = std::move(_free->buffers.back());
+            _free->buffers.pop_back();
+        }
+    }
+    if (!buffer)
+        buffer = std::make_unique<std::vector<uint16_t>>();
+    buffer->resize(size);
+
+    std::weak_ptr<free_list> free = _free;
+    return std::shared_ptr<std::vector<uint16_t>>(buffer.release(), [free](std::vector<uint16_t>* released)
+        {
+            std::unique_ptr<std::vector<uint16_t>> owned(released);
+            if (const std::shared_ptr<free_list> list = free.lock())
+            {
+                std::lock_guard<std::mutex> locker(list->mutex);
+                if (list->buffers.size() < max_free_buffers)
+                    list->buffers.push_back(std::move(owned));
+            }
+        });
+}
+
+const bool frame::Frame::has(const channel channel) const
+{
+    return (channels & channel_bit(channel)) != 0;
+}
+
+/**
+ * @brief First pixel of 'channel', nullptr if the frame does not have it.
+ */
+const uint16_t* frame::Frame::data(const channel channel) const
+{
+    if (!has(channel) || !buffer)
+        return nullptr;
+
+    // planes are stored for the present channels only
+    const int index = std::popcount(channels & (channel_bit(channel) - 1));
+    return buffer->data() + static_cast<size_t>(index) * height * width;
+}
+
+uint16_t* frame::Frame::data(const channel channel)
+{
+    return const_cast<uint16_t*>(static_cast<const Frame&>(*this).data(channel));
+}
+
+bool frame::Frame::operator==(const Frame& other) const
+{
+    if (height != other.height || width != other.width || number != other.number || time_ms != other.time_ms || channels != other.channels)
+        return false;
+    if (buffer == other.buffer)
+        return true;
+
+    return buffer && other.buffer && *buffer == *other.buffer;
+}
 
 const frame::Size frame::size(const Frame& frame)
 {
-    assert(frame.data.size() == frame.height * frame.width);
+    assert(!frame.buffer || frame.buffer->size() == static_cast<size_t>(std::popcount(frame.channels)) * frame.height * frame.width);
 
     return { .height = frame.height, .width = frame.width };
 }
@@ -16,18 +135,25 @@ const float frame::aspect(const Frame& frame)
     return static_cast<float>(frame.width) / static_cast<float>(frame.height);
 }
 
-const cv::Mat frame::to_mat(const Frame& frame)
+/**
+ * @brief CV_16UC1 header over one channel of 'frame' without copying. Only valid while the frame's buffer
+ * lives and must not be written to. Empty if the frame does not have the channel.
+ */
+const cv::Mat frame::view(const Frame& frame, const channel channel)
 {
-    cv::Mat mat(frame.height, frame.width, CV_16U);
-    for (uint32_t y = 0; y < frame.height; ++y)
-    {
-        for (uint32_t x = 0; x < frame.width; ++x)
-        {
-            mat.at<uint16_t>(cv::Point(x, y)) = frame.data[y * frame.width + x];
-        }
-    }
+    const uint16_t* data = frame.data(channel);
+    if (data == nullptr || frame.height == 0 || frame.width == 0)
+        return cv::Mat();
 
-    return mat;
+    return cv::Mat(frame.height, frame.width, CV_16UC1, const_cast<uint16_t*>(data));
+}
+
+/**
+ * @brief Copy of one channel of 'frame'. Empty if the frame does not have the channel.
+ */
+const cv::Mat frame::to_mat(const Frame& frame, const channel channel)
+{
+    return view(frame, channel).clone();
 }
 
 const frame::Frame frame::to_frame(const cv::Mat& mat)
@@ -41,15 +167,11 @@ const frame::Frame frame::to_frame(const cv::Mat& mat)
 
     frame.width = mat.cols;
     frame.height = mat.rows;
-    frame.data.resize(frame.width * frame.height);
+    frame.channels = channel_bit(channel::distance);
+    frame.buffer = std::make_shared<std::vector<uint16_t>>(static_cast<size_t>(frame.width) * frame.height);
 
     for (uint32_t y = 0; y < frame.height; ++y)
-    {
-        for (uint32_t x = 0; x < frame.width; ++x)
-        {
-            frame.data[y * frame.width + x] = mat.at<uint16_t>(cv::Point(x, y));
-        }
-    }
+        std::memcpy(frame.buffer->data() + static_cast<size_t>(y) * frame.width, mat.ptr<uint16_t>(y), frame.width * sizeof(uint16_t));
 
     return frame;
 }
@@ -0,0 +1,200 @@
+#include "common/pipeline_plan.h"
+
+#include "spdlog/spdlog.h"
+
+filter::pipeline_plan::pipeline_plan()
+	: _input_type(-1), _valid(false)
+{
+}
+
+/**
+ * @brief Compiles 'pipeline' for inputs of the given size and type. Check 'valid' for the result.
+ *
+ * @param pipeline Pipeline to compile, copied together with the state of its filters
+ * @param input_size Size of the images the plan will be executed on
+ * @param input_type OpenCV type of the images the plan will be executed on
+ */
+filter::pipeline_plan::pipeline_plan(const filter_pipeline& pipeline, const cv::Size& input_size, const int input_type)
+	: _pipeline(pipeline), _input_size(input_size), _input_type(input_type), _output_size(input_size), _valid(false)
+{
+	const size_t num_filters = _pipeline.size();
+	if (num_filters > 0)
+		_buffers.resize(num_filters - 1);
+
+	for (size_t i = 0; i < num_filters; ++i)
+	{
+		if (_pipeline.at(i).uses_scan())
+		{
+			spdlog::get("filter")->error("'{}' works on polar scans and point lists, not on images", _pipeline.at(i).type());
+			return;
+		}
+
+		frame::channel channel;
+		if ((_pipeline.at(i).uses_point_cloud() || _pipeline.at(i).uses_camera() || _pipeline.at(i).uses_channel(channel)) && _output_size != input_size)
+		{
+			spdlog::get("filter")->error("'{}' needs the camera image, it cannot follow filters changing the image size", _pipeline.at(i).type());
+			return;
+		}
+
+		cv::Size size;
+		if (!_pipeline.at(i).output_size(_output_size, size) || size.empty())
+		{
+			spdlog::get("filter")->error("'{}' cannot process a {}x{} image", _pipeline.at(i).type(), _output_size.width, _output_size.height);
+			return;
+		}
+
+		if (i + 1 < num_filters)
+			_buffers[i].create(size, input_type);
+		_output_size = size;
+	}
+
+	_valid = true;
+}
+
+const bool filter::pipeline_plan::valid() const
+{
+	return _valid;
+}
+
+const bool filter::pipeline_plan::compiled_for(const cv::Size& input_size, const int input_type) const
+{
+	return input_size == _input_size && input_type == _input_type;
+}
+
+const cv::Size filter::pipeline_plan::output_size() const
+{
+	return _output_size;
+}
+
+/**
+ * @brief Carries filter state over from the plan this one replaces, see 'filter_pipeline::adopt_state'.
+ *
+ * @param previous Plan being replaced
+ */
+void filter::pipeline_plan::adopt_state(const pipeline_plan& previous)
+{
+	_pipeline.adopt_state(previous._pipeline);
+}
+
+/**
+ * @brief Sets the camera the inputs come from, needed by point cloud filters and filters using the camera
+ * parameters. Keeping the same camera keeps the look-up tables of the points.
+ *
+ * @param camera Camera of the following inputs, may be null if the pipeline has no such filters
+ */
+void filter::pipeline_plan::set_camera(const std::shared_ptr<const cloud::camera_model>& camera)
+{
+	_camera = camera;
+}
+
+/**
+ * @brief Sets the frame the following inputs come from, needed by filters reading another channel of it.
+ * Only the frame's buffer pointer is copied.
+ *
+ * @param frame Frame of the following inputs
+ */
+void filter::pipeline_plan::set_channels(const frame::Frame& frame)
+{
+	_frame = frame;
+}
+
+/**
+ * @brief Runs all filters on 'input'.
+ *
+ * @param input Image matching the geometry the plan was compiled for
+ * @param output Filtered image, reused if it already has the output size and type
+ * @return True if successful, false otherwise
+ */
+const bool filter::pipeline_plan::execute(const cv::Mat& input, cv::Mat& output) const
+{
+	bool unchanged = false;
+	return execute(input, output, unchanged, false);
+}
+
+/**
+ * @brief Runs the filters on 'input', stopping early when a filter reports the frame as unchanged (see
+ * 'filter_base::frame_unchanged').
+ *
+ * @param input Image matching the geometry the plan was compiled for
+ * @param output Filtered image, left untouched if the frame is unchanged
+ * @param unchanged Set if the filters stopped early because the frame did not change
+ * @return True if successful, false otherwise
+ */
+const bool filter::pipeline_plan::execute(const cv::Mat& input, cv::Mat& output, bool& unchanged) const
+{
+	return execute(input, output, unchanged, true);
+}
+
+const bool filter::pipeline_plan::execute(const cv::Mat& input, cv::Mat& output, bool& unchanged, const bool skip_unchanged) const
+{
+	unchanged = false;
+	if (!_valid || !compiled_for(input.size(), input.type()))
+		return false;
+
+	if (_pipeline.empty())
+	{
+		input.copyTo(output);
+		return true;
+	}
+
+	try
+	{
+		const cv::Mat* current = &input;
+		bool points_current = false;
+		for (size_t i = 0; i < _pipeline.size(); ++i)
+		{
+			const filter_base& filter = _pipeline.at(i);
+			cv::Mat& target = i < _buffers.size() ? _buffers[i] : output;
+			frame::channel channel;
+			if (filter.uses_point_cloud())
+			{
+				// without a matching camera point cloud filters fall back to 'apply_to', which reports the error
+				points_current = points_current || _projector.project(_camera, *current, _points);
+				if (!(points_current ? filter.apply_to_cloud(*current, _points, target) : filter.apply_to(*current, target)))
+					return false;
+			}
+			else if (filter.uses_camera())
+			{
+				// the filter may change depths, so the points have to be generated again after it
+				points_current = false;
+				const bool camera_matches = _camera && current->cols == _camera->parameters.width && current->rows == _camera->parameters.height;
+				if (!(camera_matches ? filter.apply_with_camera(*current, *_camera, target) : filter.apply_to(*current, target)))
+					return false;
+			}
+			else if (filter.uses_channel(channel))
+			{
+				points_current = false;
+				if (!filter.apply_with_channel(*current, frame::view(_frame, channel), target))
+					return false;
+			}
+			else
+			{
+				points_current = false;
+				if (!filter.apply_to(*current, target))
+					return false;
+			}
+
+			if (skip_unchanged && filter.frame_unchanged())
+			{
+				unchanged = true;
+				return true;
+			}
+
+			current = &target;
+		}
+
+		return true;
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::get("filter")->error("Exception applying filters: {}", e.what());
+
+		return false;
+	}
+	catch (...)
+	{
+		spdlog::get("filter")->error("Unkown exception applying filters");
+
+		return false;
+	}
+}
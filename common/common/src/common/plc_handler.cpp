@@ -1,7 +1,43 @@
 #include "common/plc_handler.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "spdlog/spdlog.h"
 
+namespace
+{
+	/**
+	 * @brief Writes 'value' big endian as a UDInt / DInt or UInt / Int, clamped to the range of the data type.
+	 * NaN is written as 0.
+	 *
+	 * @return Position after the written value
+	 */
+	byte* put_value(byte* out, const float value, const plc::encoding data_type, const bool is_signed)
+	{
+		const double rounded = std::isnan(value) ? 0.0 : std::round(static_cast<double>(value));
+		if (data_type == plc::encoding::uint)
+		{
+			const double low = is_signed ? -32768.0 : 0.0;
+			const double high = is_signed ? 32767.0 : 65535.0;
+			const uint16_t word = static_cast<uint16_t>(static_cast<int32_t>(std::clamp(rounded, low, high)));
+			out[0] = static_cast<byte>(word >> 8);
+			out[1] = static_cast<byte>(word);
+			return out + sizeof(uint16_t);
+		}
+
+		const double low = is_signed ? -2147483648.0 : 0.0;
+		const double high = is_signed ? 2147483647.0 : 4294967295.0;
+		const double clamped = std::clamp(rounded, low, high);
+		const uint32_t dword = is_signed ? static_cast<uint32_t>(static_cast<int32_t>(clamped)) : static_cast<uint32_t>(clamped);
+		out[0] = static_cast<byte>(dword >> 24);
+		out[1] = static_cast<byte>(dword >> 16);
+		out[2] = static_cast<byte>(dword >> 8);
+		out[3] = static_cast<byte>(dword);
+		return out + sizeof(uint32_t);
+	}
+}
+
 plc::plc_handler::plc_handler()
 {
 }
@@ -55,7 +91,14 @@ const int plc::plc_handler::write_udint(const std::vector<uint32_t>& data, const
 		SetDWordAt(buffer.data(), i * static_cast<int>(sizeof(uint32_t)), data[i]);
 	}
 
-	ret = plc.DBWrite(db_number, db_offset_bytes, static_cast<int>(buffer.size()), static_cast<void *>(buffer.data()));
+	ret = write(buffer, db_number, db_offset_bytes);
+
+	return ret;
+}
+
+const int plc::plc_handler::write(const std::vector<byte>& buffer, const int db_number, const int db_offset_bytes)
+{
+	const int ret = plc.DBWrite(db_number, db_offset_bytes, static_cast<int>(buffer.size()), const_cast<byte*>(buffer.data()));
 	if (ret != 0)
 	{
 		spdlog::get("plc")->error("Failed to write to PLC: {}", CliErrorText(ret));
@@ -63,3 +106,189 @@ const int plc::plc_handler::write_udint(const std::vector<uint32_t>& data, const
 
 	return ret;
 }
+
+/**
+ * @brief Parses the PLC data type name used in the configuration file.
+ *
+ * @param name "udint", "uint" or "bits"
+ * @param parsed Parsed encoding
+ * @return False if the name is unknown
+ */
+const bool plc::parse_encoding(const std::string& name, encoding& parsed)
+{
+	if (name == "udint")
+		parsed = encoding::udint;
+	else if (name == "uint")
+		parsed = encoding::uint;
+	else if (name == "bits")
+		parsed = encoding::bits;
+	else
+		return false;
+
+	return true;
+}
+
+/**
+ * @brief Encodes a CV_16UC1 image in the given PLC data type.
+ */
+void plc::encode(const cv::Mat& mat, const encoding data_type, std::vector<byte>& buffer)
+{
+	if (data_type == encoding::uint)
+		encode_uint(mat, buffer);
+	else if (data_type == encoding::bits)
+		encode_bits(mat, buffer);
+	else
+		encode_udint(mat, buffer);
+}
+
+/**
+ * @brief Encodes a CV_16UC1 image as big endian UDInts in row-major order, ready to be written to a data block.
+ *
+ * @param mat Image to encode
+ * @param buffer Output bytes, resized to 4 bytes per pixel
+ */
+void plc::encode_udint(const cv::Mat& mat, std::vector<byte>& buffer)
+{
+	assert(mat.type() == CV_16UC1);
+
+	buffer.resize(mat.total() * sizeof(uint32_t));
+	byte* out = buffer.data();
+	for (int y = 0; y < mat.rows; ++y)
+	{
+		const uint16_t* row = mat.ptr<uint16_t>(y);
+		for (int x = 0; x < mat.cols; ++x)
+		{
+			out[0] = 0;
+			out[1] = 0;
+			out[2] = static_cast<byte>(row[x] >> 8);
+			out[3] = static_cast<byte>(row[x]);
+			out += sizeof(uint32_t);
+		}
+	}
+}
+
+/**
+ * @brief Encodes a CV_16UC1 image as big endian UInts in row-major order, half the size of 'encode_udint'.
+ *
+ * @param mat Image to encode
+ * @param buffer Output bytes, resized to 2 bytes per pixel
+ */
+void plc::encode_uint(const cv::Mat& mat, std::vector<byte>& buffer)
+{
+	assert(mat.type() == CV_16UC1);
+
+	buffer.resize(mat.total() * sizeof(uint16_t));
+	byte* out = buffer.data();
+	for (int y = 0; y < mat.rows; ++y)
+	{
+		const uint16_t* row = mat.ptr<uint16_t>(y);
+		for (int x = 0; x < mat.cols; ++x)
+		{
+			out[0] = static_cast<byte>(row[x] >> 8);
+			out[1] = static_cast<byte>(row[x]);
+			out += sizeof(uint16_t);
+		}
+	}
+}
+
+/**
+ * @brief Encodes a CV_16UC1 image as one bit per pixel, set for non-zero pixels, in row-major order. Pixel i
+ * is bit i % 8 of byte i / 8, the layout of an 'Array of Bool' in a data block. 32 times smaller than
+ * 'encode_udint'.
+ *
+ * @param mat Image to encode
+ * @param buffer Output bytes, resized to one bit per pixel rounded up to whole bytes
+ */
+void plc::encode_bits(const cv::Mat& mat, std::vector<byte>& buffer)
+{
+	assert(mat.type() == CV_16UC1);
+
+	buffer.assign((mat.total() + 7) / 8, 0);
+	size_t i = 0;
+	for (int y = 0; y < mat.rows; ++y)
+	{
+		const uint16_t* row = mat.ptr<uint16_t>(y);
+		for (int x = 0; x < mat.cols; ++x, ++i)
+			buffer[i / 8] |= static_cast<byte>((row[x] != 0) << (i % 8));
+	}
+}
+
+/**
+ * @brief Encodes a polar scan or point list in a fixed number of entries, so the data block layout does not
+ * depend on how much the camera measured. Entries past the end of the scan are zero, extra rays or points are
+ * not sent.
+ *
+ * Polar scans are one distance per ray in mm (UDInt or UInt). Point lists are x, y and z per point in mm
+ * (DInt or Int). With the bits encoding, bit i is set if ray i has a distance or point i exists.
+ *
+ * @param scan Scan to encode
+ * @param data_type PLC data type of a value
+ * @param length Number of rays or points to send
+ * @param buffer Output bytes
+ */
+void plc::encode(const frame::Scan& scan, const encoding data_type, const size_t length, std::vector<byte>& buffer)
+{
+	const size_t count = std::min(scan.size(), length);
+	const bool cartesian = scan.kind == frame::kind::cartesian;
+
+	if (data_type == encoding::bits)
+	{
+		buffer.assign((length + 7) / 8, 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (cartesian || scan.distance[i] > 0.0f)
+				buffer[i / 8] |= static_cast<byte>(1 << (i % 8));
+		}
+		return;
+	}
+
+	const size_t value_size = data_type == encoding::uint ? sizeof(uint16_t) : sizeof(uint32_t);
+	const size_t values_per_entry = cartesian ? 3 : 1;
+	buffer.assign(length * values_per_entry * value_size, 0);
+
+	byte* out = buffer.data();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (cartesian)
+		{
+			const visionary::PointXYZC& point = scan.points[i];
+			out = put_value(out, point.x, data_type, true);
+			out = put_value(out, point.y, data_type, true);
+			out = put_value(out, point.z, data_type, true);
+		}
+		else
+		{
+			// rays without a measurement may also be NaN
+			const float distance = scan.distance[i] > 0.0f ? scan.distance[i] : 0.0f;
+			out = put_value(out, distance, data_type, false);
+		}
+	}
+}
+
+/**
+ * @brief Encodes zone states as one occupied bit per zone, zone i in bit i % 8 of byte i / 8 like an 'Array
+ * of Bool', padded to whole Words. A few bytes instead of a whole image.
+ *
+ * @param states State of every zone
+ * @param distances If set, a big endian UInt per zone follows the bits with the distance of its nearest pixel
+ * in mm (0 if the zone is empty)
+ * @param buffer Output bytes
+ */
+void plc::encode(const std::vector<zones::zone_state>& states, const bool distances, std::vector<byte>& buffer)
+{
+	const size_t bits_size = (states.size() + 15) / 16 * sizeof(uint16_t);
+	buffer.assign(bits_size + (distances ? states.size() * sizeof(uint16_t) : 0), 0);
+
+	for (size_t i = 0; i < states.size(); ++i)
+	{
+		if (states[i].occupied)
+			buffer[i / 8] |= static_cast<byte>(1 << (i % 8));
+	}
+
+	if (!distances)
+		return;
+
+	byte* out = buffer.data() + bits_size;
+	for (const zones::zone_state& state : states)
+		out = put_value(out, state.min_distance, encoding::uint, false);
+}
@@ -0,0 +1,62 @@
+#include "common/point_cloud.h"
+
+#include <algorithm>
+
+bool cloud::camera_model::operator==(const camera_model& other) const
+{
+	const visionary::CameraParameters& a = parameters;
+	const visionary::CameraParameters& b = other.parameters;
+
+	return a.height == b.height && a.width == b.width
+		&& std::equal(std::begin(a.cam2worldMatrix), std::end(a.cam2worldMatrix), std::begin(b.cam2worldMatrix))
+		&& a.fx == b.fx && a.fy == b.fy && a.cx == b.cx && a.cy == b.cy
+		&& a.k1 == b.k1 && a.k2 == b.k2 && a.p1 == b.p1 && a.p2 == b.p2 && a.k3 == b.k3 && a.f2rc == b.f2rc
+		&& distance_unit == other.distance_unit && radial == other.radial;
+}
+
+/**
+ * @brief Converts a depth image of 'camera' into world space points.
+ *
+ * @param camera Camera the image was taken with
+ * @param depth CV_16UC1 depth image at the camera resolution
+ * @param points Resulting point cloud, reused if it already has the right size
+ * @return True if successful, false if there is no camera or the image does not match it
+ */
+const bool cloud::projector::project(const std::shared_ptr<const camera_model>& camera, const cv::Mat& depth, point_cloud& points)
+{
+	if (!camera || depth.type() != CV_16UC1)
+		return false;
+	if (depth.cols != camera->parameters.width || depth.rows != camera->parameters.height)
+		return false;
+
+	if (!_rays || (camera != _camera && !(_camera && *camera == *_camera)))
+		_rays = visionary::getWorldLut(camera->parameters, camera->radial);
+	_camera = camera;
+
+	const size_t cols = depth.cols;
+	const size_t num_pixels = cols * depth.rows;
+	points.size = depth.size();
+	points.x.resize(num_pixels);
+	points.y.resize(num_pixels);
+	points.z.resize(num_pixels);
+
+	// the table gives metres, the points are in millimetres
+	const float scale = camera->distance_unit * 1000.0f;
+	const float origin_x = _rays->offset.x * 1000.0f;
+	const float origin_y = _rays->offset.y * 1000.0f;
+	const float origin_z = _rays->offset.z * 1000.0f;
+	for (int y = 0; y < depth.rows; ++y)
+	{
+		const uint16_t* row = depth.ptr<uint16_t>(y);
+		const size_t first = y * cols;
+		for (size_t x = 0; x < cols; ++x)
+		{
+			const float distance = visionary::maskedDistance(row[x], scale);
+			points.x[first + x] = _rays->x[first + x] * distance + origin_x;
+			points.y[first + x] = _rays->y[first + x] * distance + origin_y;
+			points.z[first + x] = _rays->z[first + x] * distance + origin_z;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,403 @@
+#include "common/processing_loop.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "common/filters/resize_filter.h"
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	// how long the receive stage blocks for a frame before checking whether it should stop
+	constexpr uint64_t receive_timeout_ms = 1000;
+
+	// delay between PLC reconnect attempts, doubled after every failed attempt
+	constexpr std::chrono::milliseconds reconnect_delay_min(100);
+	constexpr std::chrono::milliseconds reconnect_delay_max(5000);
+}
+
+/**
+ * @brief Bytes the loop writes to the data block per frame, starting at 'db_offset_bytes'. Found by encoding
+ * an empty frame, so it always matches the encoders.
+ *
+ * @param config Loop configuration
+ * @return Size of one encoded frame
+ */
+const size_t processing::frame_size_bytes(const loop_config& config)
+{
+	std::vector<byte> buffer;
+	if (!config.zones.empty())
+	{
+		plc::encode(std::vector<zones::zone_state>(config.zones.size()), config.zone_distances, buffer);
+	}
+	else if (config.kind != frame::kind::image)
+	{
+		frame::Scan scan;
+		scan.kind = config.kind;
+		plc::encode(scan, config.encoding, static_cast<size_t>(config.frame_width), buffer);
+	}
+	else
+	{
+		plc::encode(cv::Mat(config.frame_height, config.frame_width, CV_16UC1, cv::Scalar(0)), config.encoding, buffer);
+	}
+
+	return buffer.size();
+}
+
+processing::processing_loop::processing_loop(camera::camera_handler& camera, plc::plc_handler& plc, const filter::filter_pipeline& pipeline, const loop_config& config)
+	: _camera(camera), _plc(plc), _config(config), _plan_outdated(true), _pipeline_changed(false),
+	_received(queue_capacity), _filtered(queue_capacity), _encoded(queue_capacity),
+	_zones(config.zones), _failed(false), _stopping(false)
+{
+	_pipeline = output_pipeline(pipeline);
+	_camera.set_scan_kind(_config.kind);
+}
+
+processing::processing_loop::~processing_loop()
+{
+}
+
+void processing::processing_loop::set_frame_written_callback(const std::function<void(const uint32_t frame_number)>& callback)
+{
+	_frame_written_callback = callback;
+}
+
+/**
+ * @brief Called for every frame a filter reported as unchanged, which is neither encoded nor written.
+ */
+void processing::processing_loop::set_frame_skipped_callback(const std::function<void(const uint32_t frame_number)>& callback)
+{
+	_frame_skipped_callback = callback;
+}
+
+/**
+ * @brief Replaces the filter pipeline. Takes effect before the next frame is filtered, stateful filters
+ * keep their state where the new pipeline is compatible with the old one.
+ *
+ * @param pipeline New pipeline
+ */
+void processing::processing_loop::set_pipeline(const filter::filter_pipeline& pipeline)
+{
+	std::unique_ptr<filter::filter_pipeline> next = std::make_unique<filter::filter_pipeline>(output_pipeline(pipeline));
+	{
+		std::lock_guard<std::mutex> locker(_pipeline_mutex);
+		_next_pipeline = std::move(next);
+	}
+	_pipeline_changed = true;
+}
+
+const filter::filter_pipeline processing::processing_loop::output_pipeline(const filter::filter_pipeline& pipeline) const
+{
+	filter::filter_pipeline output(pipeline);
+	if (_config.kind != frame::kind::image || !_config.zones.empty())
+		return output;
+
+	// resize to desired frame dimensions from configuration file
+	output.push_back(std::make_unique<filter::resize_filter>(_config.frame_width, _config.frame_height));
+
+	return output;
+}
+
+/**
+ * @brief Switches to the pipeline given to 'set_pipeline'. Only called from the filter stage, which
+ * owns '_pipeline'.
+ */
+void processing::processing_loop::swap_pipeline()
+{
+	std::unique_ptr<filter::filter_pipeline> next;
+	{
+		std::lock_guard<std::mutex> locker(_pipeline_mutex);
+		next = std::move(_next_pipeline);
+	}
+	if (!next)
+		return;
+
+	_pipeline = std::move(*next);
+	_plan_outdated = true;
+	spdlog::get("filter")->info("Switched to new filter pipeline");
+}
+
+/**
+ * @brief Compiles '_pipeline' for the given input geometry, keeping the state of compatible filters from
+ * the previous plan. Only called from the filter stage, which owns '_plan'.
+ */
+void processing::processing_loop::compile_plan(const cv::Size& input_size, const int input_type)
+{
+	filter::pipeline_plan plan(_pipeline, input_size, input_type);
+	plan.adopt_state(_plan);
+	_plan = std::move(plan);
+	_plan_outdated = false;
+
+	if (_plan.valid())
+		spdlog::get("filter")->info("Compiled filter pipeline for {}x{} input", input_size.width, input_size.height);
+}
+
+/**
+ * @brief Filters frames from the camera and writes them to the PLC until 'done' is set.
+ *
+ * The receive stage runs on the calling thread, the remaining stages on worker threads.
+ *
+ * @param done Flag checked after every received frame (or receive timeout) to stop the loop
+ * @return True if stopped by 'done', false if stopped by an unrecoverable exception
+ */
+const bool processing::processing_loop::run(const volatile std::atomic_bool& done)
+{
+	std::thread filter_thread(&processing_loop::run_filter, this);
+	std::thread encode_thread(&processing_loop::run_encode, this);
+	std::thread write_thread(&processing_loop::run_write, this);
+
+	while (!done && !_failed)
+	{
+		try
+		{
+			frame::Frame raw_frame;
+			// get the next frame (blocking with timeout)
+			if (_camera.get_next_frame(raw_frame, receive_timeout_ms))
+			{
+				if (_received.push(std::move(raw_frame)))
+					SPDLOG_LOGGER_DEBUG(spdlog::get("app"), "Filter stage busy, dropped oldest received frame");
+			}
+		}
+		catch (const spdlog::spdlog_ex& e)
+		{
+			std::cerr << "Logging exception: " << e.what() << ". Ignoring\n";
+		}
+		catch (const std::exception& e)
+		{
+			fail("receive", e.what());
+		}
+		catch (...)
+		{
+			fail("receive", "unknown");
+		}
+	}
+
+	stop();
+	filter_thread.join();
+	encode_thread.join();
+	write_thread.join();
+
+	return !_failed;
+}
+
+void processing::processing_loop::run_filter()
+{
+	frame::Frame raw_frame;
+	while (_received.pop(raw_frame))
+	{
+		try
+		{
+			if (_pipeline_changed.exchange(false))
+				swap_pipeline();
+
+			if (_config.kind != frame::kind::image)
+			{
+				filter_scan(raw_frame);
+				continue;
+			}
+
+			// read straight from the frame's buffer, which lives until the filters have run
+			const cv::Mat mat = frame::view(raw_frame, frame::channel::distance);
+			if (mat.empty())
+				continue;
+			if (_plan_outdated || !_plan.compiled_for(mat.size(), mat.type()))
+				compile_plan(mat.size(), mat.type());
+
+			_plan.set_camera(raw_frame.camera);
+			_plan.set_channels(raw_frame);
+
+			// apply filters. unchanged frames are neither encoded nor written, the PLC keeps the previous one
+			cv::Mat filtered;
+			bool unchanged = false;
+			if (_plan.execute(mat, filtered, unchanged))
+			{
+				if (unchanged)
+				{
+					SPDLOG_LOGGER_DEBUG(spdlog::get("filter"), "Frame #{} unchanged, skipped", raw_frame.number);
+					if (_frame_skipped_callback)
+						_frame_skipped_callback(raw_frame.number);
+				}
+				else
+					_filtered.push({ raw_frame.number, std::move(filtered), {}, raw_frame.camera });
+			}
+			else
+			{
+				uint64_t suppressed = 0;
+				if (_filter_error_limiter.allow(suppressed))
+					spdlog::get("filter")->error("Failed to apply filters on frame #{}. {} similar errors suppressed", raw_frame.number, suppressed);
+			}
+		}
+		catch (const spdlog::spdlog_ex& e)
+		{
+			std::cerr << "Logging exception: " << e.what() << ". Ignoring\n";
+		}
+		catch (const std::exception& e)
+		{
+			fail("filter", e.what());
+		}
+		catch (...)
+		{
+			fail("filter", "unknown");
+		}
+	}
+}
+
+/**
+ * @brief Filters the polar scan or point list of 'raw_frame'. Frames without one are skipped.
+ */
+void processing::processing_loop::filter_scan(const frame::Frame& raw_frame)
+{
+	const std::shared_ptr<const frame::Scan>& scan = _config.kind == frame::kind::polar ? raw_frame.polar : raw_frame.cartesian;
+	if (!scan)
+		return;
+
+	filtered_frame filtered{ raw_frame.number };
+	if (_pipeline.apply_to_scan(*scan, filtered.scan))
+	{
+		_filtered.push(std::move(filtered));
+	}
+	else
+	{
+		uint64_t suppressed = 0;
+		if (_filter_error_limiter.allow(suppressed))
+			spdlog::get("filter")->error("Failed to apply filters on frame #{}. {} similar errors suppressed", raw_frame.number, suppressed);
+	}
+}
+
+void processing::processing_loop::run_encode()
+{
+	filtered_frame filtered;
+	while (_filtered.pop(filtered))
+	{
+		try
+		{
+			if (_config.kind != frame::kind::image)
+			{
+				encoded_frame encoded{ filtered.number };
+				plc::encode(filtered.scan, _config.encoding, static_cast<size_t>(_config.frame_width), encoded.data);
+				_encoded.push(std::move(encoded));
+				continue;
+			}
+
+			if (!_zones.empty())
+			{
+				encoded_frame encoded{ filtered.number };
+				if (!_zones.evaluate(filtered.mat, filtered.camera, _zone_states))
+				{
+					uint64_t suppressed = 0;
+					if (_encode_error_limiter.allow(suppressed))
+						spdlog::get("filter")->error("Failed to evaluate zones on frame #{}. {} similar errors suppressed", filtered.number, suppressed);
+					continue;
+				}
+
+				plc::encode(_zone_states, _config.zone_distances, encoded.data);
+				_encoded.push(std::move(encoded));
+				continue;
+			}
+
+			if (filtered.mat.type() != CV_16UC1 || filtered.mat.cols != _config.frame_width || filtered.mat.rows != _config.frame_height)
+			{
+				uint64_t suppressed = 0;
+				if (_encode_error_limiter.allow(suppressed))
+					spdlog::get("filter")->error("Filtered frame #{} has unexpected size {}x{}. {} similar errors suppressed", filtered.number, filtered.mat.cols, filtered.mat.rows, suppressed);
+				continue;
+			}
+
+			// convert to the data type of the data block (UDInt or UInt in TIA Portal world)
+			encoded_frame encoded{ filtered.number };
+			plc::encode(filtered.mat, _config.encoding, encoded.data);
+			_encoded.push(std::move(encoded));
+		}
+		catch (const spdlog::spdlog_ex& e)
+		{
+			std::cerr << "Logging exception: " << e.what() << ". Ignoring\n";
+		}
+		catch (const std::exception& e)
+		{
+			fail("encode", e.what());
+		}
+		catch (...)
+		{
+			fail("encode", "unknown");
+		}
+	}
+}
+
+void processing::processing_loop::run_write()
+{
+	encoded_frame encoded;
+	while (_encoded.pop(encoded))
+	{
+		try
+		{
+			// write frame to plc
+			const int ret = _plc.write(encoded.data, _config.db_number, _config.db_offset_bytes);
+			if (ret == 0)
+			{
+				if (_frame_written_callback)
+					_frame_written_callback(encoded.number);
+				continue;
+			}
+
+			// if writing fails, assume the plc connection was lost and reconnect. frames arriving meanwhile
+			// replace each other in the queue, so the first write after reconnecting sends the newest one
+			spdlog::error("Failed to write frame #{} to PLC: {}", encoded.number, CliErrorText(ret));
+			_plc.disconnect();
+			std::chrono::milliseconds delay = reconnect_delay_min;
+			while (!wait_for_stop(delay) && _plc.connect() != 0)
+			{
+				delay = std::min(delay * 2, reconnect_delay_max);
+			}
+		}
+		catch (const spdlog::spdlog_ex& e)
+		{
+			std::cerr << "Logging exception: " << e.what() << ". Ignoring\n";
+		}
+		catch (const std::exception& e)
+		{
+			fail("write", e.what());
+		}
+		catch (...)
+		{
+			fail("write", "unknown");
+		}
+	}
+}
+
+/**
+ * @brief Closes all queues and wakes a write stage waiting to reconnect. Stages finish their current
+ * frame and exit.
+ */
+void processing::processing_loop::stop()
+{
+	{
+		std::lock_guard<std::mutex> locker(_stop_mutex);
+		_stopping = true;
+	}
+	_stop_cv.notify_all();
+
+	_received.close();
+	_filtered.close();
+	_encoded.close();
+}
+
+void processing::processing_loop::fail(const std::string& stage, const std::string& what)
+{
+	spdlog::error("Exception in {} stage: {}", stage, what);
+	_failed = true;
+	stop();
+}
+
+/**
+ * @brief Waits for 'timeout' unless the loop is stopped first.
+ *
+ * @return True if the loop was stopped
+ */
+const bool processing::processing_loop::wait_for_stop(const std::chrono::milliseconds& timeout)
+{
+	std::unique_lock<std::mutex> locker(_stop_mutex);
+	return _stop_cv.wait_for(locker, timeout, [this]() { return _stopping; });
+}
@@ -0,0 +1,38 @@
+#include "common/rate_limiter.h"
+
+logging::rate_limiter::rate_limiter(const std::chrono::milliseconds& interval)
+	: _interval(interval), _next_allowed(std::chrono::steady_clock::time_point::min().time_since_epoch().count()), _suppressed(0)
+{
+}
+
+logging::rate_limiter::rate_limiter(const rate_limiter& other)
+	: rate_limiter(std::chrono::duration_cast<std::chrono::milliseconds>(other._interval))
+{
+}
+
+logging::rate_limiter& logging::rate_limiter::operator=(const rate_limiter& other)
+{
+	_interval = other._interval;
+	return *this;
+}
+
+/**
+ * @brief Checks whether a message may be logged now.
+ *
+ * @param suppressed Number of messages held back since the last allowed one, only set if allowed
+ * @return True if the caller should log
+ */
+const bool logging::rate_limiter::allow(uint64_t& suppressed)
+{
+	const std::chrono::steady_clock::rep now = std::chrono::steady_clock::now().time_since_epoch().count();
+	std::chrono::steady_clock::rep next_allowed = _next_allowed.load();
+
+	if (now < next_allowed || !_next_allowed.compare_exchange_strong(next_allowed, now + _interval.count()))
+	{
+		++_suppressed;
+		return false;
+	}
+
+	suppressed = _suppressed.exchange(0);
+	return true;
+}
@@ -0,0 +1,234 @@
+#include "common/run_length.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+	/**
+	 * @brief Grows every run by 'radius' on both sides, merging runs that touch.
+	 */
+	void expand(const std::vector<rle::run>& runs, const int radius, const int cols, std::vector<rle::run>& output)
+	{
+		output.clear();
+		for (const rle::run& r : runs)
+		{
+			const int start = std::max(r.start - radius, 0);
+			const int end = std::min(r.end + radius, cols);
+			if (!output.empty() && start <= output.back().end)
+				output.back().end = std::max(output.back().end, end);
+			else
+				output.push_back({ start, end });
+		}
+	}
+
+	/**
+	 * @brief Shrinks every run by 'radius' on both sides. Pixels outside the row count as set, so runs
+	 * touching the border do not shrink there.
+	 */
+	void shrink(const std::vector<rle::run>& runs, const int radius, const int cols, std::vector<rle::run>& output)
+	{
+		output.clear();
+		for (const rle::run& r : runs)
+		{
+			const int start = r.start == 0 ? 0 : r.start + radius;
+			const int end = r.end == cols ? cols : r.end - radius;
+			if (start < end)
+				output.push_back({ start, end });
+		}
+	}
+
+	void unite(const std::vector<rle::run>& a, const std::vector<rle::run>& b, std::vector<rle::run>& output)
+	{
+		output.clear();
+		size_t i = 0, j = 0;
+		while (i < a.size() || j < b.size())
+		{
+			const rle::run& next = (j == b.size() || (i < a.size() && a[i].start < b[j].start)) ? a[i++] : b[j++];
+			if (!output.empty() && next.start <= output.back().end)
+				output.back().end = std::max(output.back().end, next.end);
+			else
+				output.push_back(next);
+		}
+	}
+
+	void intersect(const std::vector<rle::run>& a, const std::vector<rle::run>& b, std::vector<rle::run>& output)
+	{
+		output.clear();
+		size_t i = 0, j = 0;
+		while (i < a.size() && j < b.size())
+		{
+			const int start = std::max(a[i].start, b[j].start);
+			const int end = std::min(a[i].end, b[j].end);
+			if (start < end)
+				output.push_back({ start, end });
+
+			if (a[i].end < b[j].end)
+				++i;
+			else
+				++j;
+		}
+	}
+
+	int find_root(std::vector<int>& parent, int i)
+	{
+		while (parent[i] != i)
+		{
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	}
+}
+
+/**
+ * @brief Run length encodes the valid (non-zero) pixels of a CV_16UC1 depth image.
+ */
+const rle::run_mask rle::encode(const cv::Mat& depth)
+{
+	run_mask mask{ depth.size(), std::vector<std::vector<run>>(depth.rows) };
+	for (int y = 0; y < depth.rows; ++y)
+	{
+		const uint16_t* row = depth.ptr<uint16_t>(y);
+		std::vector<run>& runs = mask.rows[y];
+		int x = 0;
+		while (x < depth.cols)
+		{
+			while (x < depth.cols && row[x] == 0)
+				++x;
+			const int start = x;
+			while (x < depth.cols && row[x] != 0)
+				++x;
+			if (start < x)
+				runs.push_back({ start, x });
+		}
+	}
+
+	return mask;
+}
+
+/**
+ * @brief Dilation with a (2 * radius + 1) square structuring element, done separably: runs are grown
+ * horizontally, then every row becomes the union of its vertical neighbours.
+ */
+const rle::run_mask rle::dilate(const run_mask& mask, const int radius)
+{
+	const int rows = mask.size.height;
+	std::vector<std::vector<run>> horizontal(rows);
+	for (int y = 0; y < rows; ++y)
+		expand(mask.rows[y], radius, mask.size.width, horizontal[y]);
+
+	run_mask output{ mask.size, std::vector<std::vector<run>>(rows) };
+	std::vector<run> merged;
+	for (int y = 0; y < rows; ++y)
+	{
+		std::vector<run>& result = output.rows[y];
+		for (int j = std::max(y - radius, 0); j <= std::min(y + radius, rows - 1); ++j)
+		{
+			unite(result, horizontal[j], merged);
+			result.swap(merged);
+		}
+	}
+
+	return output;
+}
+
+/**
+ * @brief Erosion with a (2 * radius + 1) square structuring element. Pixels outside the image count as
+ * set, like OpenCV's default border for erosion.
+ */
+const rle::run_mask rle::erode(const run_mask& mask, const int radius)
+{
+	const int rows = mask.size.height;
+	std::vector<std::vector<run>> horizontal(rows);
+	for (int y = 0; y < rows; ++y)
+		shrink(mask.rows[y], radius, mask.size.width, horizontal[y]);
+
+	run_mask output{ mask.size, std::vector<std::vector<run>>(rows) };
+	std::vector<run> common;
+	for (int y = 0; y < rows; ++y)
+	{
+		const int y0 = std::max(y - radius, 0);
+		const int y1 = std::min(y + radius, rows - 1);
+
+		std::vector<run>& result = output.rows[y];
+		result = horizontal[y0];
+		for (int j = y0 + 1; j <= y1 && !result.empty(); ++j)
+		{
+			intersect(result, horizontal[j], common);
+			result.swap(common);
+		}
+	}
+
+	return output;
+}
+
+/**
+ * @brief Removes 8-connected components smaller than 'min_area' pixels.
+ *
+ * Runs in neighbouring rows are joined with union-find, so the cost depends on the number of runs
+ * rather than the number of pixels.
+ *
+ * @return Number of removed pixels
+ */
+const uint64_t rle::remove_small_components(run_mask& mask, const int min_area)
+{
+	const int rows = mask.size.height;
+
+	// index of the first run of every row in 'parent'
+	std::vector<size_t> first(rows + 1, 0);
+	for (int y = 0; y < rows; ++y)
+		first[y + 1] = first[y] + mask.rows[y].size();
+
+	std::vector<int> parent(first[rows]);
+	std::iota(parent.begin(), parent.end(), 0);
+
+	for (int y = 1; y < rows; ++y)
+	{
+		const std::vector<run>& above = mask.rows[y - 1];
+		const std::vector<run>& current = mask.rows[y];
+		size_t i = 0, j = 0;
+		while (i < above.size() && j < current.size())
+		{
+			// runs touch diagonally when one starts right where the other ends
+			if (above[i].start <= current[j].end && current[j].start <= above[i].end)
+			{
+				const int a = find_root(parent, static_cast<int>(first[y - 1] + i));
+				const int b = find_root(parent, static_cast<int>(first[y] + j));
+				parent[std::max(a, b)] = std::min(a, b);
+			}
+
+			if (above[i].end < current[j].end)
+				++i;
+			else
+				++j;
+		}
+	}
+
+	std::vector<uint64_t> area(parent.size(), 0);
+	for (int y = 0; y < rows; ++y)
+	{
+		for (size_t i = 0; i < mask.rows[y].size(); ++i)
+		{
+			const run& r = mask.rows[y][i];
+			area[find_root(parent, static_cast<int>(first[y] + i))] += r.end - r.start;
+		}
+	}
+
+	uint64_t removed = 0;
+	for (int y = 0; y < rows; ++y)
+	{
+		std::vector<run>& runs = mask.rows[y];
+		size_t kept = 0;
+		for (size_t i = 0; i < runs.size(); ++i)
+		{
+			if (area[find_root(parent, static_cast<int>(first[y] + i))] >= static_cast<uint64_t>(min_area))
+				runs[kept++] = runs[i];
+			else
+				removed += runs[i].end - runs[i].start;
+		}
+		runs.resize(kept);
+	}
+
+	return removed;
+}
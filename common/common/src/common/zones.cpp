@@ -0,0 +1,292 @@
+#include "common/zones.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "spdlog/spdlog.h"
+
+namespace
+{
+	/**
+	 * @brief Depth values of a camera with 'unit' millimetres per value that lie in [min, max] millimetres.
+	 * Zero and 0xFFFF are never included, the camera marks invalid pixels with them.
+	 *
+	 * @return False if no value lies in the range
+	 */
+	const bool depth_range(const float min, const float max, const float unit, uint16_t& lower, uint16_t& upper)
+	{
+		const double low = std::max(std::ceil(static_cast<double>(min) / unit), 1.0);
+		const double high = std::min(std::floor(static_cast<double>(max) / unit), 65534.0);
+		if (!(low <= high))
+			return false;
+
+		lower = static_cast<uint16_t>(low);
+		upper = static_cast<uint16_t>(high);
+		return true;
+	}
+}
+
+/**
+ * @brief Reads the zones of the configuration file.
+ *
+ * @param zones Array of zones, each with a 'name', either a 'polygon' of [x, y] pixel corners with an
+ * optional 'distance' range or a world space 'box', and an optional 'min_pixels'
+ * @param parsed Parsed zones, in the order of the array
+ * @return False if a zone is malformed
+ */
+const bool zones::parse_zones(const nlohmann::json& zones, std::vector<zone>& parsed)
+{
+	try
+	{
+		parsed.clear();
+		for (const nlohmann::json& zone_json : zones)
+		{
+			zone zone{};
+			zone.name = zone_json.value("name", std::string());
+			zone.min_pixels = std::max(zone_json.value("min_pixels", 1), 1);
+
+			if (zone_json.contains("box"))
+			{
+				zone.shape = zone_shape::box;
+				const char* axes[] = { "x", "y", "z" };
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					zone.box_min[axis] = zone_json["box"][axes[axis]]["min"].get<float>();
+					zone.box_max[axis] = zone_json["box"][axes[axis]]["max"].get<float>();
+					if (zone.box_max[axis] < zone.box_min[axis])
+						std::swap(zone.box_min[axis], zone.box_max[axis]);
+				}
+			}
+			else
+			{
+				zone.shape = zone_shape::polygon;
+				for (const nlohmann::json& corner : zone_json["polygon"])
+					zone.polygon.emplace_back(corner.at(0).get<float>(), corner.at(1).get<float>());
+				if (zone.polygon.size() < 3)
+				{
+					spdlog::error("Zone '{}' needs at least 3 polygon corners", zone.name);
+					return false;
+				}
+
+				zone.distance_min = 0.0f;
+				zone.distance_max = std::numeric_limits<float>::max();
+				if (zone_json.contains("distance"))
+				{
+					zone.distance_min = zone_json["distance"].value("min", zone.distance_min);
+					zone.distance_max = zone_json["distance"].value("max", zone.distance_max);
+				}
+			}
+
+			parsed.push_back(zone);
+		}
+	}
+	catch (const nlohmann::detail::exception& e)
+	{
+		spdlog::error("Failed to load zones from json: {}", e.what());
+		return false;
+	}
+
+	return true;
+}
+
+zones::zone_engine::zone_engine(const std::vector<zone>& zones)
+	: _zones(zones)
+{
+}
+
+const bool zones::zone_engine::empty() const
+{
+	return _zones.empty();
+}
+
+/**
+ * @brief True if a zone is a world space box, which needs the image at the camera resolution.
+ */
+const bool zones::zone_engine::needs_camera() const
+{
+	return std::any_of(_zones.begin(), _zones.end(), [](const zone& zone) { return zone.shape == zone_shape::box; });
+}
+
+/**
+ * @brief Computes the state of every zone for a filtered depth image, compiling the zones first if the image
+ * size or camera changed.
+ *
+ * @param depth CV_16UC1 depth image
+ * @param camera Camera the image was taken with, may be null if there are no box zones
+ * @param states State of every zone, in configuration order
+ * @return False if the zones cannot be evaluated on this image
+ */
+const bool zones::zone_engine::evaluate(const cv::Mat& depth, const std::shared_ptr<const cloud::camera_model>& camera, std::vector<zone_state>& states)
+{
+	if (depth.empty() || depth.type() != CV_16UC1)
+		return false;
+
+	if (depth.size() != _size || (camera != _camera && !(camera && _camera && *camera == *_camera)))
+	{
+		// remembered even when compiling fails, so a bad configuration is reported once and not every frame
+		_size = depth.size();
+		_camera = camera;
+		if (!compile(_size, _camera))
+			_compiled.clear();
+	}
+	if (_compiled.size() != _zones.size())
+		return false;
+
+	const float unit = _camera ? _camera->distance_unit : 1.0f;
+	states.resize(_zones.size());
+	for (size_t i = 0; i < _zones.size(); ++i)
+	{
+		const compiled_zone& compiled = _compiled[i];
+		uint32_t pixels = 0;
+		uint16_t nearest = std::numeric_limits<uint16_t>::max();
+
+		size_t k = 0;
+		for (const span& s : compiled.spans)
+		{
+			const uint16_t* row = depth.ptr<uint16_t>(s.y);
+			for (int x = s.start; x < s.end; ++x, ++k)
+			{
+				const uint16_t value = row[x];
+				const bool inside = value >= compiled.lower[k] && value <= compiled.upper[k];
+				pixels += inside;
+				nearest = inside ? std::min(nearest, value) : nearest;
+			}
+		}
+
+		states[i].occupied = pixels >= static_cast<uint32_t>(_zones[i].min_pixels);
+		states[i].pixels = pixels;
+		states[i].min_distance = pixels > 0 ? nearest * unit : 0.0f;
+	}
+
+	return true;
+}
+
+const bool zones::zone_engine::compile(const cv::Size& size, const std::shared_ptr<const cloud::camera_model>& camera)
+{
+	std::shared_ptr<const visionary::WorldLut> rays;
+	if (needs_camera())
+	{
+		if (!camera || camera->parameters.width != size.width || camera->parameters.height != size.height)
+		{
+			spdlog::get("filter")->error("Box zones need the image at the camera resolution, the filters return {}x{}", size.width, size.height);
+			return false;
+		}
+		rays = visionary::getWorldLut(camera->parameters, camera->radial);
+	}
+
+	const float unit = camera ? camera->distance_unit : 1.0f;
+	_compiled.assign(_zones.size(), compiled_zone());
+	for (size_t i = 0; i < _zones.size(); ++i)
+	{
+		if (_zones[i].shape == zone_shape::box)
+			compile_box(_zones[i], *rays, unit, _compiled[i]);
+		else
+			compile_polygon(_zones[i], unit, _compiled[i]);
+	}
+
+	spdlog::get("filter")->info("Compiled {} zones for {}x{} input", _zones.size(), size.width, size.height);
+	return true;
+}
+
+/**
+ * @brief Pixels whose centre lies inside the polygon (even-odd rule), found per row from the crossings of
+ * the polygon edges with the row centre.
+ */
+void zones::zone_engine::compile_polygon(const zone& zone, const float unit, compiled_zone& compiled) const
+{
+	uint16_t lower = 0;
+	uint16_t upper = 0;
+	if (!depth_range(zone.distance_min, zone.distance_max, unit, lower, upper))
+		return;
+
+	std::vector<float> crossings;
+	const size_t corners = zone.polygon.size();
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const float centre = static_cast<float>(y) + 0.5f;
+		crossings.clear();
+		for (size_t i = 0; i < corners; ++i)
+		{
+			const cv::Point2f& a = zone.polygon[i];
+			const cv::Point2f& b = zone.polygon[(i + 1) % corners];
+			if ((a.y <= centre) != (b.y <= centre))
+				crossings.push_back(a.x + (centre - a.y) * (b.x - a.x) / (b.y - a.y));
+		}
+		std::sort(crossings.begin(), crossings.end());
+
+		for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+		{
+			const int start = std::clamp(static_cast<int>(std::ceil(crossings[i] - 0.5f)), 0, _size.width);
+			const int end = std::clamp(static_cast<int>(std::ceil(crossings[i + 1] - 0.5f)), 0, _size.width);
+			if (start < end)
+				compiled.spans.push_back({ y, start, end });
+		}
+	}
+
+	size_t pixels = 0;
+	for (const span& s : compiled.spans)
+		pixels += s.end - s.start;
+	compiled.lower.assign(pixels, lower);
+	compiled.upper.assign(pixels, upper);
+}
+
+/**
+ * @brief Pixels whose ray crosses the box, with the distances along the ray between entering and leaving it
+ * (slab test per axis). The rays are in metres per millimetre, so the box is converted to metres and the
+ * distances come out in millimetres.
+ */
+void zones::zone_engine::compile_box(const zone& zone, const visionary::WorldLut& rays, const float unit, compiled_zone& compiled) const
+{
+	const visionary::AlignedFloatVector* directions[3] = { &rays.x, &rays.y, &rays.z };
+	const float origin[3] = { rays.offset.x, rays.offset.y, rays.offset.z };
+	float box_min[3];
+	float box_max[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		box_min[axis] = zone.box_min[axis] / 1000.0f;
+		box_max[axis] = zone.box_max[axis] / 1000.0f;
+	}
+
+	for (int y = 0; y < _size.height; ++y)
+	{
+		bool in_span = false;
+		for (int x = 0; x < _size.width; ++x)
+		{
+			const size_t i = static_cast<size_t>(y) * _size.width + x;
+			float enter = 0.0f;
+			float leave = std::numeric_limits<float>::max();
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float direction = (*directions[axis])[i];
+				if (direction == 0.0f)
+				{
+					if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis])
+						leave = -1.0f;
+					continue;
+				}
+
+				float t0 = (box_min[axis] - origin[axis]) / direction;
+				float t1 = (box_max[axis] - origin[axis]) / direction;
+				if (t0 > t1)
+					std::swap(t0, t1);
+				enter = std::max(enter, t0);
+				leave = std::min(leave, t1);
+			}
+
+			uint16_t lower = 0;
+			uint16_t upper = 0;
+			const bool inside = enter <= leave && depth_range(enter, leave, unit, lower, upper);
+			if (inside)
+			{
+				if (in_span)
+					compiled.spans.back().end = x + 1;
+				else
+					compiled.spans.push_back({ y, x, x + 1 });
+				compiled.lower.push_back(lower);
+				compiled.upper.push_back(upper);
+			}
+			in_span = inside;
+		}
+	}
+}
@@ -24,6 +24,8 @@ namespace window
 	private:
 		int _octets[4];
 		int _port;
+		// index of the camera::camera_type
+		int _type;
 		camera::camera_handler _camera;
 	};
 }
\ No newline at end of file
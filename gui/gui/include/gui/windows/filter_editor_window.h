@@ -17,18 +17,23 @@ namespace window
 		filter_editor_window(const char* name, bool* p_open = (bool*)0, ImGuiWindowFlags flags = 0);
 		~filter_editor_window() override;
 		const bool create_pipeline(filter::filter_pipeline& pipeline) const;
+		const uint64_t version() const;
 
 	protected:
 		void render_content() override;
 
 	private:
 		int curr_id;
+		// incremented on every edit of the graph or of a filter parameter
+		uint64_t _version;
 		filter::filter_graph _graph;
 		filter::filter_pipeline _last_pipeline;
+		// filter types offered when adding a node
+		std::vector<std::string> _node_types;
 
 		void handle_input();
 		void render_nodes();
-		void render_node_inputs(const nlohmann::json& json, nlohmann::json& new_json);
+		const bool render_node_inputs(const nlohmann::json& json, nlohmann::json& new_json);
 		void render_links();
 		void handle_link_changes();
 		void handle_node_changes();
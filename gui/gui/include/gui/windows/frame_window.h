@@ -20,6 +20,8 @@ namespace window
 	private:
 		bool _need_to_generate;
 		bool _apply_colormap;
+		// index of the displayed 'frame::channel', only selectable for frames with more than one channel
+		int _channel;
 		cv::Mat _mat;
 		frame::Frame _frame;
 		GLuint _texture;
@@ -57,9 +57,13 @@ int main(int, char**)
     ImGuiIO& io = ImGui::GetIO(); (void)io;
 
     cv::Mat filtered_mat;
+    frame::Frame camera_frame;
     frame::Frame filtered_frame;
     filter::filter_pipeline pipeline;
+    bool pipeline_ok = false;
+    uint64_t pipeline_version = 0;
     filter::filter_worker worker;
+    window::frame_window camera_frame_window("Camera Frame");
     window::frame_window filtered_frame_window("Filtered Frame");
     window::filter_editor_window editor_window("Filter Editor");
     window::camera_handler_window camera_handler_window("Camera Handler");
@@ -80,21 +84,25 @@ int main(int, char**)
         editor_window.render();
         camera_handler_window.render();
         
-        bool pipeline_ok = editor_window.create_pipeline(pipeline);
-        if (pipeline_ok)
+        // only rebuild the pipeline after the graph or a filter parameter was edited
+        if (editor_window.version() != pipeline_version)
         {
-            frame::Frame depth;
-            if (camera_handler_window.get_current_frame(depth))
-            {
-                const cv::Mat& depth_mat = frame::to_mat(depth);
+            pipeline_version = editor_window.version();
+            pipeline_ok = editor_window.create_pipeline(pipeline);
+            if (pipeline_ok)
                 worker.set_pipeline(pipeline);
-                worker.try_put_new(depth_mat);
-            }
         }
 
+        // the worker shares the frame's buffer, no channel is copied
+        if (camera_handler_window.get_current_frame(camera_frame) && pipeline_ok)
+            worker.try_put_new(camera_frame);
+
         if (worker.try_latest_mat(filtered_mat) && !filtered_mat.empty())
             filtered_frame = frame::to_frame(filtered_mat);
 
+        camera_frame_window.set_frame(camera_frame);
+        camera_frame_window.render();
+
         filtered_frame_window.set_frame(filtered_frame);
         filtered_frame_window.render();
 
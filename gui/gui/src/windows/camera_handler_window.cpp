@@ -3,7 +3,7 @@
 #include "spdlog/spdlog.h"
 
 window::camera_handler_window::camera_handler_window(const char* name, bool* p_open, ImGuiWindowFlags flags)
-	: window_base(name, p_open, flags), _octets(), _port(0)
+	: window_base(name, p_open, flags), _octets(), _port(0), _type(0)
 {
 }
 
@@ -72,11 +72,18 @@ void window::camera_handler_window::render_content()
     ImGui::PopID();
     ImGui::EndGroup();
 
+    ImGui::SameLine();
+    ImGui::PushItemWidth(width / 3.0f);
+    // in camera::camera_type order
+    const char* types[] = { "Visionary-T Mini", "Visionary-S", "Visionary-T" };
+    ImGui::Combo("Type", &_type, types, IM_ARRAYSIZE(types));
+    ImGui::PopItemWidth();
+
     ImGui::SameLine();
     if (ImGui::Button("Connect"))
     {
         std::stringstream ip;
         ip << _octets[0] << "." << _octets[1] << "." << _octets[2] << "." << _octets[3];
-        _camera.open(ip.str(), static_cast<uint16_t>(_port), 5000);
+        _camera.open(ip.str(), static_cast<uint16_t>(_port), 5000, static_cast<camera::camera_type>(_type));
     }
 }
\ No newline at end of file
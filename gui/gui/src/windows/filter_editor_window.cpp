@@ -8,8 +8,14 @@
 #include "ImGuiFileDialog.h"
 
 window::filter_editor_window::filter_editor_window(const char* name, bool* p_open, ImGuiWindowFlags flags)
-	: window_base(name, p_open, flags), curr_id(0), _graph({})
+	: window_base(name, p_open, flags), curr_id(0), _version(1), _graph({})
 {
+	// the gui pipeline runs on images, which scan filters reject
+	for (const auto& filter : filter::types)
+	{
+		if (!filter.second()->uses_scan())
+			_node_types.push_back(filter.first);
+	}
 }
 
 window::filter_editor_window::~filter_editor_window()
@@ -37,6 +43,17 @@ const bool window::filter_editor_window::create_pipeline(filter::filter_pipeline
 	return true;
 }
 
+/**
+ * @brief Version of the filter graph. Changes whenever the pipeline created by 'create_pipeline' would change,
+ * so callers only need to recreate the pipeline when the version differs from the one they last used.
+ *
+ * @return Current version
+ */
+const uint64_t window::filter_editor_window::version() const
+{
+	return _version;
+}
+
 void window::filter_editor_window::render_content()
 {
 	ImNodes::BeginNodeEditor();
@@ -62,11 +79,11 @@ void window::filter_editor_window::handle_input()
 	if (ImGui::BeginPopup("###add_node_popup"))
 	{
 		ImGui::SeparatorText("Filter type");
-		for (const auto& filter : filter::types)
+		for (const std::string& type : _node_types)
 		{
-			if (ImGui::Button(filter.first.c_str()))
+			if (ImGui::Button(type.c_str()))
 			{
-				node_added = add_node(filter.first);
+				node_added = add_node(type);
 			}
 		}
 
@@ -107,16 +124,20 @@ void window::filter_editor_window::render_nodes()
 
 		{
 			nlohmann::json new_parameters;
-			render_node_inputs(node.filter->to_json(), new_parameters);
-			node.filter->load_json(new_parameters);
+			if (render_node_inputs(node.filter->to_json(), new_parameters))
+			{
+				node.filter->load_json(new_parameters);
+				++_version;
+			}
 		}
 		ImNodes::EndNode();
 		ImNodes::PopColorStyle();
 	}
 }
 
-void window::filter_editor_window::render_node_inputs(const nlohmann::json& json, nlohmann::json& new_json)
+const bool window::filter_editor_window::render_node_inputs(const nlohmann::json& json, nlohmann::json& new_json)
 {
+	bool changed = false;
 	try
 	{
 		const auto& parameters = json["parameters"];
@@ -132,13 +153,13 @@ void window::filter_editor_window::render_node_inputs(const nlohmann::json& json
 				if (item.value().is_number_float())
 				{
 					double value = item.value().get<double>();
-					ImGui::InputDouble(item.key().c_str(), &value);
+					changed |= ImGui::InputDouble(item.key().c_str(), &value);
 					new_json[item.key()] = value;
 				}
 				else if (item.value().is_number_integer())
 				{
 					int value = item.value().get<int>();
-					ImGui::InputInt(item.key().c_str(), &value);
+					changed |= ImGui::InputInt(item.key().c_str(), &value);
 					new_json[item.key()] = value;
 				}
 				else
@@ -159,7 +180,10 @@ void window::filter_editor_window::render_node_inputs(const nlohmann::json& json
 	catch (const std::exception& e)
 	{
 		spdlog::get("ui")->error(e.what());
+		return false;
 	}
+
+	return changed;
 }
 
 void window::filter_editor_window::render_links()
@@ -192,13 +216,13 @@ void window::filter_editor_window::handle_link_changes()
 		if (_graph.links().size() + 1 > _graph.nodes().size() - 1)
 			can_add = false;
 
-		if (can_add)
-			_graph.add_link({ .id = ++curr_id, .in_id = start, .out_id = end });
+		if (can_add && _graph.add_link({ .id = ++curr_id, .in_id = start, .out_id = end }))
+			++_version;
 	}
 
 	int link_id;
-	if (ImNodes::IsLinkDestroyed(&link_id))
-		_graph.remove_link(link_id);
+	if (ImNodes::IsLinkDestroyed(&link_id) && _graph.remove_link(link_id))
+		++_version;
 
 	const int num_selected_links = ImNodes::NumSelectedLinks();
 	if (num_selected_links > 0 && ImGui::IsKeyReleased(ImGuiKey::ImGuiKey_Delete))
@@ -207,7 +231,8 @@ void window::filter_editor_window::handle_link_changes()
 		sel_links.resize(static_cast<size_t>(num_selected_links));
 		ImNodes::GetSelectedLinks(sel_links.data());
 		for (const auto& link_id : sel_links)
-			_graph.remove_link(link_id);
+			if (_graph.remove_link(link_id))
+				++_version;
 	}
 }
 
@@ -220,7 +245,8 @@ void window::filter_editor_window::handle_node_changes()
 		sel_nodes.resize(static_cast<size_t>(num_selected_nodes));
 		ImNodes::GetSelectedNodes(sel_nodes.data());
 		for (const auto& node_id : sel_nodes)
-			_graph.remove_node(node_id);
+			if (_graph.remove_node(node_id))
+				++_version;
 	}
 }
 
@@ -298,5 +324,9 @@ const bool window::filter_editor_window::add_node(const std::string& filter_type
 		std::move(filter)
 	);
 
-	return _graph.add_node(std::move(node));
+	if (!_graph.add_node(std::move(node)))
+		return false;
+
+	++_version;
+	return true;
 }
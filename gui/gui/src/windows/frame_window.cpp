@@ -1,4 +1,7 @@
 #include "gui/windows/frame_window.h"
+
+#include <bit>
+
 #include "spdlog/spdlog.h"
 #include "opencv2/imgproc.hpp"
 #include "gui/frame_helper.h"
@@ -6,7 +9,7 @@
 namespace window
 {
     frame_window::frame_window(const char* name, bool* p_open, ImGuiWindowFlags flags)
-	    : window_base(name, p_open, flags), _need_to_generate(true), _texture(0), _apply_colormap(true)
+	    : window_base(name, p_open, flags), _need_to_generate(true), _texture(0), _apply_colormap(true), _channel(0)
     {
 	    glGenTextures(1, &_texture);
     }
@@ -35,6 +38,19 @@ namespace window
         if (ImGui::Checkbox("Apply", &_apply_colormap))
             _need_to_generate = true;
 
+        if (std::popcount(_frame.channels) > 1)
+        {
+            const char* names[frame::num_channels];
+            for (size_t i = 0; i < frame::num_channels; ++i)
+                names[i] = frame::channel_name(static_cast<frame::channel>(i));
+
+            ImGui::SameLine();
+            ImGui::PushItemWidth(100.0f);
+            if (ImGui::Combo("Channel", &_channel, names, static_cast<int>(frame::num_channels)))
+                _need_to_generate = true;
+            ImGui::PopItemWidth();
+        }
+
         _need_to_generate = true;
 
         if (_need_to_generate)
@@ -58,7 +74,12 @@ namespace window
         if (frame_size.height == 0 || frame_size.width == 0)
             return false;   
 
-        _mat = frame::to_mat(_frame);
+        // filter outputs only have distance
+        const frame::channel selected = static_cast<frame::channel>(_channel);
+        const frame::channel channel = _frame.has(selected) ? selected : frame::channel::distance;
+        _mat = frame::to_mat(_frame, channel);
+        if (_mat.empty())
+            return false;
 
         if (_apply_colormap)
         {
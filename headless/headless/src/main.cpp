@@ -1,5 +1,6 @@
 #include <chrono>
 #include <csignal>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <thread>
@@ -8,6 +9,7 @@
 #include "CLI11.hpp"
 
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/daily_file_sink.h"
 
@@ -18,7 +20,7 @@
 #include "common/filter_pipeline.h"
 #include "common/camera_handler.h"
 #include "common/plc_handler.h"
-#include "common/frame.h"
+#include "common/processing_loop.h"
 
 #include "opencv2/core/utils/logger.hpp"
 
@@ -43,6 +45,14 @@ static const nlohmann::json config_schema = R"(
             "port": {
               "type": "number"
             },
+            "type": {
+              "type": "string",
+              "enum": [
+                "visionary-t-mini",
+                "visionary-s",
+                "visionary-t"
+              ]
+            },
             "frame": {
               "type": "object",
               "properties": {
@@ -51,6 +61,14 @@ static const nlohmann::json config_schema = R"(
                 },
                 "height": {
                   "type": "number"
+                },
+                "kind": {
+                  "type": "string",
+                  "enum": [
+                    "image",
+                    "polar",
+                    "cartesian"
+                  ]
                 }
               },
               "required": [
@@ -82,6 +100,17 @@ static const nlohmann::json config_schema = R"(
             },
             "db_offset_bytes": {
               "type": "number"
+            },
+            "encoding": {
+              "type": "string",
+              "enum": [
+                "udint",
+                "uint",
+                "bits"
+              ]
+            },
+            "zone_distances": {
+              "type": "boolean"
             }
           },
           "required": [
@@ -91,6 +120,74 @@ static const nlohmann::json config_schema = R"(
             "db_number",
             "db_offset_bytes"
           ]
+        },
+        "zones": {
+          "type": "array",
+          "items": {
+            "type": "object",
+            "properties": {
+              "name": {
+                "type": "string"
+              },
+              "polygon": {
+                "type": "array",
+                "items": {
+                  "type": "array",
+                  "items": {
+                    "type": "number"
+                  },
+                  "minItems": 2,
+                  "maxItems": 2
+                },
+                "minItems": 3
+              },
+              "distance": {
+                "type": "object",
+                "properties": {
+                  "min": {
+                    "type": "number"
+                  },
+                  "max": {
+                    "type": "number"
+                  }
+                }
+              },
+              "box": {
+                "type": "object",
+                "properties": {
+                  "x": {
+                    "type": "object"
+                  },
+                  "y": {
+                    "type": "object"
+                  },
+                  "z": {
+                    "type": "object"
+                  }
+                },
+                "required": [
+                  "x",
+                  "y",
+                  "z"
+                ]
+              },
+              "min_pixels": {
+                "type": "number"
+              }
+            },
+            "oneOf": [
+              {
+                "required": [
+                  "polygon"
+                ]
+              },
+              {
+                "required": [
+                  "box"
+                ]
+              }
+            ]
+          }
         }
       },
       "required": [
@@ -110,6 +207,7 @@ volatile std::atomic_bool done = false;
 void setup_loggers();
 const bool parse_and_validate_config(const std::string& path, nlohmann::json& config);
 const bool parse_filters(const std::string& path, filter::filter_pipeline& pipeline);
+void watch_filters(const std::string& path, processing::processing_loop& loop);
 void signal_handler(int signum);
 
 int main(int argc, char** argv)
@@ -145,6 +243,13 @@ int main(int argc, char** argv)
 		return EXIT_FAILURE;
 	}
 
+	// zones are optional, a malformed one is a configuration error
+	std::vector<zones::zone> zone_list;
+	if (config.contains("zones") && !zones::parse_zones(config["zones"], zone_list))
+	{
+		return EXIT_FAILURE;
+	}
+
 	// log parsed configuration and filters
 	spdlog::get("app")->info("Using configuration:\n{}", config.dump(2));
 	spdlog::get("app")->info("Using filters:\n{}", pipeline.to_json().dump(2));
@@ -162,72 +267,50 @@ int main(int argc, char** argv)
 	// connect to camera. if unsuccessful, keep trying with a 5 second timeout
 	const std::string& cam_ip = config["camera"]["ip"].get<std::string>();
 	const uint16_t cam_port = config["camera"]["port"].get<uint16_t>();
+	// optional, the schema only allows known names
+	camera::camera_type cam_type = camera::camera_type::visionary_t_mini;
+	if (config["camera"].contains("type"))
+		camera::parse_camera_type(config["camera"]["type"].get<std::string>(), cam_type);
 	camera::camera_handler camera;
-	while (!done && !camera.open(cam_ip, cam_port, 1000))
+	while (!done && !camera.open(cam_ip, cam_port, 1000, cam_type))
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(5000));
 	}
 
 	// loop indefinitely, filtering and sending frames to the plc
-	const int db_number = config["plc"]["db_number"].get<int>();
-	const int db_offset_bytes = config["plc"]["db_offset_bytes"].get<int>();
-	const int frame_width = config["camera"]["frame"]["width"].get<int>();
-	const int frame_height = config["camera"]["frame"]["height"].get<int>();
-	while (!done)
+	processing::loop_config loop_config;
+	loop_config.db_number = config["plc"]["db_number"].get<int>();
+	loop_config.db_offset_bytes = config["plc"]["db_offset_bytes"].get<int>();
+	loop_config.frame_width = config["camera"]["frame"]["width"].get<int>();
+	loop_config.frame_height = config["camera"]["frame"]["height"].get<int>();
+	// optional, the schema only allows known names
+	if (config["camera"]["frame"].contains("kind"))
+		frame::parse_kind(config["camera"]["frame"]["kind"].get<std::string>(), loop_config.kind);
+	// optional, the schema only allows known names
+	loop_config.encoding = plc::encoding::udint;
+	if (config["plc"].contains("encoding"))
+		plc::parse_encoding(config["plc"]["encoding"].get<std::string>(), loop_config.encoding);
+	loop_config.zones = zone_list;
+	loop_config.zone_distances = config["plc"].value("zone_distances", false);
+	processing::processing_loop loop(camera, plc, pipeline, loop_config);
+
+	// reload filters when the filter file changes, without reconnecting to the camera or plc
+	std::thread filter_watcher;
+	if (app.count("--filters") > 0)
 	{
-		try
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-			frame::Frame raw_frame;
-			// get the next frame (blocking with timeout)
-			if (camera.get_next_frame(raw_frame, 5000/*ms*/))
-			{
-				cv::Mat raw_mat = frame::to_mat(raw_frame);
-				// apply filters
-				if (pipeline.apply(raw_mat))
-				{
-					cv::Mat filtered_mat;
-					// resize to desired frame dimensions from configuration file
-					cv::resize(raw_mat, filtered_mat, cv::Size(frame_width, frame_height), 0.0, 0.0, cv::InterpolationFlags::INTER_AREA);
-					const frame::Frame filtered_frame = frame::to_frame(filtered_mat);
-
-					const std::vector<uint16_t> distance_map_16 = filtered_frame.data;
-					// convert to uint32_t (UDint in TIA Portal world)
-					const std::vector<uint32_t> distance_map(distance_map_16.begin(), distance_map_16.end());
-
-					// write frame to plc
-					const int ret = plc.write_udint(distance_map, db_number, db_offset_bytes);
-					// if writing fails, assume the plc connection was lost and try to reconnect
-					if (ret != 0)
-					{
-						spdlog::error("Failed to write frame #{} to PLC: {}", filtered_frame.number, CliErrorText(ret));
-						plc.disconnect();
-						std::this_thread::sleep_for(std::chrono::milliseconds(5000));
-						plc.connect();
-					}
-				}
-				else
-				{
-					spdlog::get("filter")->error("Failed to apply filters on frame #{}", raw_frame.number);
-					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-				}
-			}
-		}
-		catch (const spdlog::spdlog_ex& e)
-		{
-			std::cerr << "Logging exception: " << e.what() << ". Ignoring\n";
-		}
-		catch (const std::exception& e)
-		{
-			spdlog::error("Exception in main loop: {}", e.what());
-			return EXIT_FAILURE;
-		}
-		catch (...)
-		{
-			spdlog::error("Unkown exception in main loop");
-			return EXIT_FAILURE;
-		}
+		filter_watcher = std::thread(watch_filters, filter_path, std::ref(loop));
+	}
+
+	const bool loop_ok = loop.run(done);
+	done = true;
+	if (filter_watcher.joinable())
+	{
+		filter_watcher.join();
+	}
+
+	if (!loop_ok)
+	{
+		return EXIT_FAILURE;
 	}
 
 	return EXIT_SUCCESS;
@@ -236,9 +319,15 @@ int main(int argc, char** argv)
 /**
  * @brief Creates logger objects and sets logging levels.
  * 
+ * Loggers are asynchronous so console and file output never block the processing loop. If the
+ * queue fills up the oldest messages are dropped.
  */
 void setup_loggers()
 {
+	spdlog::init_thread_pool(8192, 1);
+	// flush and join the logging thread before exit so queued messages are not lost
+	std::atexit([]() { spdlog::shutdown(); });
+
 	// create stdout and a daily log file sink
 	std::vector<spdlog::sink_ptr> sinks;
 	sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
@@ -255,12 +344,17 @@ void setup_loggers()
 	// create and register loggers in global registry
 	for (const char* log_name : log_names)
 	{
-		spdlog::register_logger(std::make_shared<spdlog::logger>((log_name), sinks.begin(), sinks.end()));
+		spdlog::register_logger(std::make_shared<spdlog::async_logger>((log_name), sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest));
 	}
 
 	// sets 'app' logger as default logger (i.e. spdlog::info() is functionally equivalent to spdlog::get("app")->info())
 	spdlog::set_default_logger(spdlog::get(log_names[0]));
+#ifdef _DEBUG
 	spdlog::set_level(spdlog::level::trace);
+#else
+	spdlog::set_level(spdlog::level::info);
+#endif // _DEBUG
+	spdlog::flush_on(spdlog::level::err);
 	cv::utils::logging::setLogLevel(cv::utils::logging::LOG_LEVEL_ERROR);
 }
 
@@ -335,6 +429,43 @@ const bool parse_filters(const std::string& path, filter::filter_pipeline& pipel
 	return true;
 }
 
+/**
+ * @brief Polls the filter file for changes and hands every successfully parsed version to the
+ * processing loop. Returns once 'done' is set.
+ *
+ * The modification time is polled because the application targets Windows, where inotify is not
+ * available, and a check every 500 ms is negligible next to frame processing.
+ *
+ * @param path Path to JSON file containing filter definitions
+ * @param loop Processing loop to update
+ */
+void watch_filters(const std::string& path, processing::processing_loop& loop)
+{
+	std::error_code error;
+	std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(path, error);
+
+	while (!done)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+		const std::filesystem::file_time_type write_time = std::filesystem::last_write_time(path, error);
+		if (error || write_time == last_write_time)
+			continue;
+		last_write_time = write_time;
+
+		// editors may still be writing the file, a failed parse is retried on the next change
+		filter::filter_pipeline pipeline;
+		if (!parse_filters(path, pipeline))
+		{
+			spdlog::get("app")->error("Failed to reload filters from '{}', keeping current filters", path);
+			continue;
+		}
+
+		spdlog::get("app")->info("Reloaded filters:\n{}", pipeline.to_json().dump(2));
+		loop.set_pipeline(pipeline);
+	}
+}
+
 /**
  * @brief Handles ctrl+c and other signals.
  * 